@@ -111,6 +111,12 @@ class AndroidBuilderTests : BuilderTests() {
         assertTrue(result.success, "Reader fromContext test failed: ${result.message}")
     }
 
+    @Test
+    fun runTestCborRoundTrip() = runBlocking {
+        val result = testCborRoundTrip()
+        assertTrue(result.success, "CBOR Round-trip test failed: ${result.message}")
+    }
+
     @Test
     fun runTestBuilderSetIntent() = runBlocking {
         val result = testBuilderSetIntent()
@@ -134,4 +140,34 @@ class AndroidBuilderTests : BuilderTests() {
         val result = testBuilderIntentEditAndUpdate()
         assertTrue(result.success, "Builder Intent Edit and Update test failed: ${result.message}")
     }
+
+    @Test
+    fun runTestSharedContextUpdate() = runBlocking {
+        val result = testSharedContextUpdate()
+        assertTrue(result.success, "Shared Context Update test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestParsedManifestStore() = runBlocking {
+        val result = testParsedManifestStore()
+        assertTrue(result.success, "Parsed Manifest Store test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestIncrementalResign() = runBlocking {
+        val result = testIncrementalResign()
+        assertTrue(result.success, "Incremental Re-sign test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestCollectionSigning() = runBlocking {
+        val result = testCollectionSigning()
+        assertTrue(result.success, "Collection Signing test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestBoxHashSigning() = runBlocking {
+        val result = testBoxHashSigning()
+        assertTrue(result.success, "Box Hash Signing test failed: ${result.message}")
+    }
 }
@@ -92,4 +92,28 @@ class AndroidCoreTests : CoreTests() {
         val result = testErrorEnumCoverage()
         assertTrue(result.success, "Error Enum Coverage test failed: ${result.message}")
     }
+
+    @Test
+    fun runTestVerificationLevels() = runBlocking {
+        val result = testVerificationLevels()
+        assertTrue(result.success, "Verification Levels test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestLazyIngredientValidation() = runBlocking {
+        val result = testLazyIngredientValidation()
+        assertTrue(result.success, "Lazy Ingredient Validation test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestSignatureVerificationCache() = runBlocking {
+        val result = testSignatureVerificationCache()
+        assertTrue(result.success, "Signature Verification Cache test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestRevocationIndex() = runBlocking {
+        val result = testRevocationIndex()
+        assertTrue(result.success, "Revocation Index test failed: ${result.message}")
+    }
 }
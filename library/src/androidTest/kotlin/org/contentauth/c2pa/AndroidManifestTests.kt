@@ -261,4 +261,16 @@ class AndroidManifestTests : ManifestTests() {
         val result = testStandardAssertionLabelSerialNames()
         assertTrue(result.success, "StandardAssertionLabel serialNames test failed: ${result.message}")
     }
+
+    @Test
+    fun runTestManifestStoreView() = runBlocking {
+        val result = testManifestStoreView()
+        assertTrue(result.success, "ManifestStoreView lazy access test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestManifestValidatorBatch() = runBlocking {
+        val result = testManifestValidatorBatch()
+        assertTrue(result.success, "ManifestValidator batch validation test failed: ${result.message}")
+    }
 }
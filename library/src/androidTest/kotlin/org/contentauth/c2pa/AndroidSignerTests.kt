@@ -116,4 +116,46 @@ class AndroidSignerTests : SignerTests() {
         val result = testSignerFromSettingsJson()
         assertTrue(result.success, "Signer From Settings (JSON) test failed: ${result.message}")
     }
+
+    @Test
+    fun runTestSignerFromContext() = runBlocking {
+        val result = testSignerFromContext()
+        assertTrue(result.success, "Signer From Context test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestEd25519KeyBatch() = runBlocking {
+        val result = testEd25519KeyBatch()
+        assertTrue(result.success, "Ed25519 Key Batch test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestKeyStoreSigningPipeline() = runBlocking {
+        val result = testKeyStoreSigningPipeline()
+        assertTrue(result.success, "KeyStore Signing Pipeline test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestSignerPool() = runBlocking {
+        val result = testSignerPool()
+        assertTrue(result.success, "Signer Pool test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestCertificateLifecycleManager() = runBlocking {
+        val result = testCertificateLifecycleManager()
+        assertTrue(result.success, "Certificate Lifecycle Manager test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestAdaptiveReserveSize() = runBlocking {
+        val result = testAdaptiveReserveSize()
+        assertTrue(result.success, "Adaptive Reserve Size test failed: ${result.message}")
+    }
+
+    @Test
+    fun runTestBatchSignerPipelinedTimestamps() = runBlocking {
+        val result = testBatchSignerPipelinedTimestamps()
+        assertTrue(result.success, "Batch Signer Pipelined Timestamps test failed: ${result.message}")
+    }
 }
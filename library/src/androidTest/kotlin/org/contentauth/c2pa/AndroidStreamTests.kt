@@ -86,4 +86,10 @@ class AndroidStreamTests : StreamTests() {
             "File Operations with Data Directory test failed: ${result.message}",
         )
     }
+
+    @Test
+    fun runTestHttpRangeStream() = runBlocking {
+        val result = testHttpRangeStream()
+        assertTrue(result.success, "HTTP Range Stream test failed: ${result.message}")
+    }
 }
@@ -64,6 +64,12 @@ class AndroidWebServiceTests : WebServiceTests() {
         }
     }
 
+    @Test
+    fun runTestHedgedWebServiceSigning() = runBlocking {
+        val result = testHedgedWebServiceSigning()
+        assertTrue(result.success, "Hedged Web Service Signing test failed: ${result.message}")
+    }
+
     @Test
     fun runTestCSRSigning() = runBlocking {
         val result = testCSRSigning()
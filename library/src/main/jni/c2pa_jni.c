@@ -9,6 +9,7 @@
 #include <string.h>
 #include <pthread.h>
 #include "c2pa.h"
+#include "cbor_json.h"
 
 // Global JavaVM reference for callback handling
 static JavaVM *g_jvm = NULL;
@@ -582,31 +583,6 @@ JNIEXPORT void JNICALL Java_org_contentauth_c2pa_Stream_releaseStreamNative(JNIE
 }
 
 // Reader native methods
-JNIEXPORT jlong JNICALL Java_org_contentauth_c2pa_Reader_fromStreamNative(JNIEnv *env, jclass clazz, jstring format, jlong streamPtr) {
-    if (format == NULL || streamPtr == 0) {
-        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
-                         "Format and stream cannot be null");
-        return 0;
-    }
-    
-    const char *cformat = jstring_to_cstring(env, format);
-    if (cformat == NULL) {
-        return 0;
-    }
-    
-    struct C2paStream *stream = (struct C2paStream*)(uintptr_t)streamPtr;
-    struct C2paReader *reader = c2pa_reader_from_stream(cformat, stream);
-    
-    release_cstring(env, format, cformat);
-    
-    if (reader == NULL) {
-        throw_c2pa_exception(env, "Failed to create reader from stream");
-        return 0;
-    }
-    
-    return (jlong)(uintptr_t)reader;
-}
-
 JNIEXPORT jlong JNICALL Java_org_contentauth_c2pa_Reader_fromManifestDataAndStreamNative(JNIEnv *env, jclass clazz, jstring format, jlong streamPtr, jbyteArray manifestData) {
     if (format == NULL || streamPtr == 0 || manifestData == NULL) {
         (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
@@ -651,6 +627,37 @@ JNIEXPORT jlong JNICALL Java_org_contentauth_c2pa_Reader_fromManifestDataAndStre
     return (jlong)(uintptr_t)reader;
 }
 
+JNIEXPORT jlong JNICALL Java_org_contentauth_c2pa_ParsedManifestStore_bindNative(JNIEnv *env, jclass clazz, jstring format, jlong streamPtr, jobject manifestBuffer, jlong length) {
+    if (format == NULL || streamPtr == 0 || manifestBuffer == NULL) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
+                         "Format, stream, and manifest buffer cannot be null");
+        return 0;
+    }
+    
+    // The store stays in its direct buffer; no copy is made per binding
+    const unsigned char *data = (const unsigned char*)(*env)->GetDirectBufferAddress(env, manifestBuffer);
+    jlong capacity = (*env)->GetDirectBufferCapacity(env, manifestBuffer);
+    if (data == NULL || length <= 0 || length > capacity) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
+                         "Manifest buffer must be a non-empty direct buffer");
+        return 0;
+    }
+    
+    const char *cformat = jstring_to_cstring(env, format);
+    if (cformat == NULL) {
+        return 0;
+    }
+    
+    struct C2paStream *stream = (struct C2paStream*)(uintptr_t)streamPtr;
+    struct C2paReader *reader = c2pa_reader_from_manifest_data_and_stream(
+        cformat, stream, data, (uintptr_t)length
+    );
+    
+    release_cstring(env, format, cformat);
+    
+    return (jlong)(uintptr_t)reader;
+}
+
 JNIEXPORT void JNICALL Java_org_contentauth_c2pa_Reader_free(JNIEnv *env, jobject obj, jlong readerPtr) {
     if (readerPtr != 0) {
         c2pa_reader_free((struct C2paReader*)(uintptr_t)readerPtr);
@@ -697,6 +704,41 @@ JNIEXPORT jstring JNICALL Java_org_contentauth_c2pa_Reader_toDetailedJsonNative(
     return result;
 }
 
+JNIEXPORT jbyteArray JNICALL Java_org_contentauth_c2pa_Reader_toCborNative(JNIEnv *env, jobject obj, jlong readerPtr) {
+    if (readerPtr == 0) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalStateException"), 
+                         "Reader is not initialized");
+        return NULL;
+    }
+    
+    struct C2paReader *reader = (struct C2paReader*)(uintptr_t)readerPtr;
+    char *json = c2pa_reader_json(reader);
+    
+    if (json == NULL) {
+        throw_c2pa_exception(env, "Failed to generate JSON from reader");
+        return NULL;
+    }
+    
+    // Transcode here so the manifest store never becomes a Java string
+    uint8_t *cbor = NULL;
+    size_t cborLen = 0;
+    int status = json_to_cbor(json, &cbor, &cborLen);
+    c2pa_string_free(json);
+    
+    if (status != 0) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalStateException"), 
+                         "Failed to encode manifest store as CBOR");
+        return NULL;
+    }
+    
+    jbyteArray result = safe_new_byte_array(env, (jsize)cborLen);
+    if (result != NULL) {
+        (*env)->SetByteArrayRegion(env, result, 0, (jsize)cborLen, (const jbyte*)cbor);
+    }
+    free(cbor);
+    return result;
+}
+
 JNIEXPORT jstring JNICALL Java_org_contentauth_c2pa_Reader_remoteUrlNative(JNIEnv *env, jobject obj, jlong readerPtr) {
     if (readerPtr == 0) {
         (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalStateException"), 
@@ -1248,6 +1290,49 @@ JNIEXPORT jint JNICALL Java_org_contentauth_c2pa_C2PASettings_setValueNative(JNI
     return result;
 }
 
+JNIEXPORT jint JNICALL Java_org_contentauth_c2pa_C2PASettings_setValuesNative(JNIEnv *env, jobject obj, jlong settingsPtr, jobjectArray paths, jobjectArray values) {
+    if (settingsPtr == 0 || paths == NULL || values == NULL) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
+                         "Settings, paths and values must not be null");
+        return -1;
+    }
+
+    jsize count = (*env)->GetArrayLength(env, paths);
+    if ((*env)->GetArrayLength(env, values) != count) {
+        (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
+                         "Paths and values must have the same length");
+        return -1;
+    }
+
+    // Apply the whole batch in one JNI transition; stop at the first rejected value
+    struct C2paSettings *settings = (struct C2paSettings*)(uintptr_t)settingsPtr;
+    for (jsize i = 0; i < count; i++) {
+        jstring path = (jstring)(*env)->GetObjectArrayElement(env, paths, i);
+        jstring value = (jstring)(*env)->GetObjectArrayElement(env, values, i);
+        const char *cpath = jstring_to_cstring(env, path);
+        const char *cvalue = jstring_to_cstring(env, value);
+
+        int result = -1;
+        if (cpath != NULL && cvalue != NULL) {
+            result = c2pa_settings_set_value(settings, cpath, cvalue);
+        } else if (!(*env)->ExceptionCheck(env)) {
+            (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), 
+                             "Settings paths and values must not be null");
+        }
+
+        release_cstring(env, path, cpath);
+        release_cstring(env, value, cvalue);
+        if (path != NULL) (*env)->DeleteLocalRef(env, path);
+        if (value != NULL) (*env)->DeleteLocalRef(env, value);
+
+        if (result < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 JNIEXPORT void JNICALL Java_org_contentauth_c2pa_C2PASettings_free(JNIEnv *env, jobject obj, jlong settingsPtr) {
     if (settingsPtr != 0) {
         c2pa_free((const void*)(uintptr_t)settingsPtr);
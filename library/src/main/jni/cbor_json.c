@@ -0,0 +1,386 @@
+/*
+ * JSON -> CBOR transcoding for the C2PA JNI bridge
+ *
+ * JSON numbers become CBOR integers when they are integral and fit in 64
+ * bits, and doubles otherwise; everything else maps one to one.
+ */
+
+#include "cbor_json.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nesting limit to bound recursion on hostile input
+#define MAX_DEPTH 512
+
+// Growable byte buffer used as the output of both transcoders
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} ByteBuffer;
+
+static int buf_reserve(ByteBuffer *b, size_t extra) {
+    if (b->len + extra <= b->cap) return 0;
+    size_t cap = b->cap ? b->cap : 256;
+    while (cap < b->len + extra) {
+        if (cap > SIZE_MAX / 2) return -1;
+        cap *= 2;
+    }
+    uint8_t *data = realloc(b->data, cap);
+    if (data == NULL) return -1;
+    b->data = data;
+    b->cap = cap;
+    return 0;
+}
+
+static int buf_append(ByteBuffer *b, const void *src, size_t n) {
+    if (buf_reserve(b, n) != 0) return -1;
+    memcpy(b->data + b->len, src, n);
+    b->len += n;
+    return 0;
+}
+
+static int buf_push(ByteBuffer *b, uint8_t byte) {
+    return buf_append(b, &byte, 1);
+}
+
+// Encodes a CBOR head (major type + argument) into out, returning its size
+static size_t cbor_encode_head(uint8_t major, uint64_t value, uint8_t out[9]) {
+    major = (uint8_t)(major << 5);
+    if (value < 24) {
+        out[0] = major | (uint8_t)value;
+        return 1;
+    }
+    if (value <= 0xFF) {
+        out[0] = major | 24;
+        out[1] = (uint8_t)value;
+        return 2;
+    }
+    if (value <= 0xFFFF) {
+        out[0] = major | 25;
+        out[1] = (uint8_t)(value >> 8);
+        out[2] = (uint8_t)value;
+        return 3;
+    }
+    if (value <= 0xFFFFFFFFULL) {
+        out[0] = major | 26;
+        for (int i = 0; i < 4; i++) out[1 + i] = (uint8_t)(value >> (24 - 8 * i));
+        return 5;
+    }
+    out[0] = major | 27;
+    for (int i = 0; i < 8; i++) out[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+    return 9;
+}
+
+static int cbor_write_head(ByteBuffer *b, uint8_t major, uint64_t value) {
+    uint8_t head[9];
+    return buf_append(b, head, cbor_encode_head(major, value, head));
+}
+
+// JSON -> CBOR
+
+// Unused bytes left in a reserved head slot, removed in one pass at the end
+typedef struct {
+    size_t offset;
+    size_t len;
+} Gap;
+
+typedef struct {
+    const char *p;
+    ByteBuffer out;
+    int depth;
+    Gap *gaps;
+    size_t gap_count;
+    size_t gap_cap;
+} JsonParser;
+
+// The length of a string or container is only known after its content is written, so room
+// for the largest head is reserved in front of it and patched once the content is done
+#define HEAD_SLOT 9
+
+static int cbor_reserve_head(JsonParser *jp, size_t *offset) {
+    *offset = jp->out.len;
+    if (buf_reserve(&jp->out, HEAD_SLOT) != 0) return -1;
+    jp->out.len += HEAD_SLOT;
+    return 0;
+}
+
+// Writes the head at the end of its slot and records the unused bytes in front of it
+static int cbor_patch_head(JsonParser *jp, size_t offset, uint8_t major, uint64_t value) {
+    uint8_t head[HEAD_SLOT];
+    size_t n = cbor_encode_head(major, value, head);
+    memcpy(jp->out.data + offset + HEAD_SLOT - n, head, n);
+    if (n == HEAD_SLOT) return 0;
+
+    if (jp->gap_count == jp->gap_cap) {
+        size_t cap = jp->gap_cap ? jp->gap_cap * 2 : 64;
+        Gap *gaps = realloc(jp->gaps, cap * sizeof(Gap));
+        if (gaps == NULL) return -1;
+        jp->gaps = gaps;
+        jp->gap_cap = cap;
+    }
+    jp->gaps[jp->gap_count].offset = offset;
+    jp->gaps[jp->gap_count].len = HEAD_SLOT - n;
+    jp->gap_count++;
+    return 0;
+}
+
+static int gap_compare(const void *a, const void *b) {
+    size_t x = ((const Gap *)a)->offset;
+    size_t y = ((const Gap *)b)->offset;
+    return x < y ? -1 : x > y;
+}
+
+// Removes every gap, moving each byte of the output at most once
+static void cbor_compact(JsonParser *jp) {
+    if (jp->gap_count == 0) return;
+    qsort(jp->gaps, jp->gap_count, sizeof(Gap), gap_compare);
+    size_t write = jp->gaps[0].offset;
+    for (size_t i = 0; i < jp->gap_count; i++) {
+        size_t from = jp->gaps[i].offset + jp->gaps[i].len;
+        size_t to = i + 1 < jp->gap_count ? jp->gaps[i + 1].offset : jp->out.len;
+        memmove(jp->out.data + write, jp->out.data + from, to - from);
+        write += to - from;
+    }
+    jp->out.len = write;
+}
+
+static void json_skip_ws(JsonParser *jp) {
+    while (*jp->p == ' ' || *jp->p == '\t' || *jp->p == '\n' || *jp->p == '\r') jp->p++;
+}
+
+static int json_literal(JsonParser *jp, const char *literal, uint8_t simple) {
+    size_t n = strlen(literal);
+    if (strncmp(jp->p, literal, n) != 0) return -1;
+    jp->p += n;
+    return buf_push(&jp->out, simple);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int json_read_hex4(JsonParser *jp, uint32_t *out) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(jp->p[i]);
+        if (h < 0) return -1;
+        value = (value << 4) | (uint32_t)h;
+    }
+    jp->p += 4;
+    *out = value;
+    return 0;
+}
+
+static int utf8_append(ByteBuffer *b, uint32_t cp) {
+    uint8_t tmp[4];
+    size_t n;
+    if (cp < 0x80) {
+        tmp[0] = (uint8_t)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        tmp[0] = (uint8_t)(0xC0 | (cp >> 6));
+        tmp[1] = (uint8_t)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        tmp[0] = (uint8_t)(0xE0 | (cp >> 12));
+        tmp[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[2] = (uint8_t)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        tmp[0] = (uint8_t)(0xF0 | (cp >> 18));
+        tmp[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+        tmp[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[3] = (uint8_t)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    return buf_append(b, tmp, n);
+}
+
+// Parses a JSON string (cursor on the opening quote) into a CBOR text string
+static int json_string(JsonParser *jp) {
+    jp->p++;
+    size_t head;
+    if (cbor_reserve_head(jp, &head) != 0) return -1;
+    size_t start = jp->out.len;
+    for (;;) {
+        const char *run = jp->p;
+        while (*jp->p != '"' && *jp->p != '\\' && (unsigned char)*jp->p >= 0x20) jp->p++;
+        if (jp->p > run && buf_append(&jp->out, run, (size_t)(jp->p - run)) != 0) return -1;
+
+        char c = *jp->p;
+        if (c == '"') {
+            jp->p++;
+            break;
+        }
+        if (c != '\\') return -1;  // control character or end of input
+
+        jp->p++;
+        uint8_t unescaped;
+        switch (*jp->p++) {
+            case '"': unescaped = '"'; break;
+            case '\\': unescaped = '\\'; break;
+            case '/': unescaped = '/'; break;
+            case 'b': unescaped = '\b'; break;
+            case 'f': unescaped = '\f'; break;
+            case 'n': unescaped = '\n'; break;
+            case 'r': unescaped = '\r'; break;
+            case 't': unescaped = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (json_read_hex4(jp, &cp) != 0) return -1;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low;
+                    if (jp->p[0] != '\\' || jp->p[1] != 'u') return -1;
+                    jp->p += 2;
+                    if (json_read_hex4(jp, &low) != 0 || low < 0xDC00 || low > 0xDFFF) return -1;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return -1;
+                }
+                if (utf8_append(&jp->out, cp) != 0) return -1;
+                continue;
+            }
+            default:
+                return -1;
+        }
+        if (buf_push(&jp->out, unescaped) != 0) return -1;
+    }
+    return cbor_patch_head(jp, head, 3, jp->out.len - start);
+}
+
+static int json_number(JsonParser *jp) {
+    const char *start = jp->p;
+    int is_integer = 1;
+
+    if (*jp->p == '-') jp->p++;
+    if (*jp->p < '0' || *jp->p > '9') return -1;
+    // RFC 8259: no leading zeros, so a 0 integer part stands alone
+    if (*jp->p == '0') {
+        jp->p++;
+        if (*jp->p >= '0' && *jp->p <= '9') return -1;
+    } else {
+        while (*jp->p >= '0' && *jp->p <= '9') jp->p++;
+    }
+    if (*jp->p == '.') {
+        is_integer = 0;
+        jp->p++;
+        if (*jp->p < '0' || *jp->p > '9') return -1;
+        while (*jp->p >= '0' && *jp->p <= '9') jp->p++;
+    }
+    if (*jp->p == 'e' || *jp->p == 'E') {
+        is_integer = 0;
+        jp->p++;
+        if (*jp->p == '+' || *jp->p == '-') jp->p++;
+        if (*jp->p < '0' || *jp->p > '9') return -1;
+        while (*jp->p >= '0' && *jp->p <= '9') jp->p++;
+    }
+
+    if (is_integer) {
+        int negative = *start == '-';
+        const char *digits = negative ? start + 1 : start;
+        uint64_t magnitude = 0;
+        int overflow = 0;
+        for (const char *d = digits; d < jp->p; d++) {
+            uint64_t digit = (uint64_t)(*d - '0');
+            if (magnitude > (UINT64_MAX - digit) / 10) {
+                overflow = 1;
+                break;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+        if (!overflow) {
+            if (!negative) return cbor_write_head(&jp->out, 0, magnitude);
+            if (magnitude > 0) return cbor_write_head(&jp->out, 1, magnitude - 1);
+            // "-0" falls through and is kept as a float
+        }
+    }
+
+    // The token was validated above, so strtod stops exactly where the scan did
+    char *end;
+    union { double d; uint64_t u; } bits;
+    errno = 0;
+    bits.d = strtod(start, &end);
+    if (end != jp->p) return -1;
+    if (errno == ERANGE && isinf(bits.d)) return -1;  // out of double range
+    uint8_t encoded[9] = { 0xFB };
+    for (int i = 0; i < 8; i++) encoded[1 + i] = (uint8_t)(bits.u >> (56 - 8 * i));
+    return buf_append(&jp->out, encoded, sizeof(encoded));
+}
+
+static int json_value(JsonParser *jp);
+
+static int json_container(JsonParser *jp, char close, uint8_t major) {
+    if (++jp->depth > MAX_DEPTH) return -1;
+    jp->p++;
+    size_t head;
+    if (cbor_reserve_head(jp, &head) != 0) return -1;
+    uint64_t count = 0;
+
+    json_skip_ws(jp);
+    if (*jp->p == close) {
+        jp->p++;
+    } else {
+        for (;;) {
+            json_skip_ws(jp);
+            if (major == 5) {
+                if (*jp->p != '"' || json_string(jp) != 0) return -1;
+                json_skip_ws(jp);
+                if (*jp->p++ != ':') return -1;
+                json_skip_ws(jp);
+            }
+            if (json_value(jp) != 0) return -1;
+            count++;
+            json_skip_ws(jp);
+            if (*jp->p == ',') {
+                jp->p++;
+                continue;
+            }
+            if (*jp->p++ != close) return -1;
+            break;
+        }
+    }
+
+    jp->depth--;
+    return cbor_patch_head(jp, head, major, count);
+}
+
+static int json_value(JsonParser *jp) {
+    json_skip_ws(jp);
+    switch (*jp->p) {
+        case '{': return json_container(jp, '}', 5);
+        case '[': return json_container(jp, ']', 4);
+        case '"': return json_string(jp);
+        case 't': return json_literal(jp, "true", 0xF5);
+        case 'f': return json_literal(jp, "false", 0xF4);
+        case 'n': return json_literal(jp, "null", 0xF6);
+        default: return json_number(jp);
+    }
+}
+
+int json_to_cbor(const char *json, uint8_t **out, size_t *out_len) {
+    if (json == NULL || out == NULL || out_len == NULL) return -1;
+
+    JsonParser jp = { json, { NULL, 0, 0 }, 0, NULL, 0, 0 };
+    int result = json_value(&jp);
+    if (result == 0) {
+        json_skip_ws(&jp);
+        if (*jp.p != '\0') result = -1;
+    }
+    if (result == 0) cbor_compact(&jp);
+    free(jp.gaps);
+    if (result != 0) {
+        free(jp.out.data);
+        return -1;
+    }
+
+    *out = jp.out.data;
+    *out_len = jp.out.len;
+    return 0;
+}
@@ -0,0 +1,20 @@
+/*
+ * JSON -> CBOR transcoding for the C2PA JNI bridge
+ *
+ * The c2pa C API only produces JSON text. This lets the JNI layer hand the
+ * reader's manifest store to Kotlin as CBOR (RFC 8949) without creating an
+ * intermediate Java string.
+ */
+
+#ifndef CBOR_JSON_H
+#define CBOR_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Transcodes a NUL-terminated JSON document to CBOR.
+// On success returns 0 and stores a malloc'd buffer in *out (free with free()).
+// Returns -1 if the JSON is malformed or memory cannot be allocated.
+int json_to_cbor(const char *json, uint8_t **out, size_t *out_len);
+
+#endif // CBOR_JSON_H
@@ -0,0 +1,164 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.coroutines.sync.withPermit
+import java.io.Closeable
+import java.util.concurrent.ConcurrentLinkedQueue
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Signs batches of assets with their time stamp requests overlapping.
+ *
+ * When a signer has a TSA URL, each [Builder.sign] call signs the claim and then waits for an
+ * RFC 3161 round trip before it returns. Signing a batch one asset at a time therefore takes
+ * roughly the TSA latency times the number of assets. A batch signer starts each asset as soon as
+ * a slot is free and keeps up to [maxInFlight] signs, and so TSA requests, outstanding at once.
+ * Each result is delivered as soon as its token has been embedded. Wall time is then bounded by
+ * signing throughput, or by TSA latency times `assets / maxInFlight`.
+ *
+ * Signers are created with [signerFactory] as concurrency requires and reused across jobs; each
+ * is used by one job at a time. They are closed with the batch signer.
+ *
+ * ```kotlin
+ * BatchSigner({ Signer.fromKeys(certs, key, SigningAlgorithm.ES256, tsaURL) }).use { batch ->
+ *     val results = batch.signAll(assets.map { BatchSigner.Job(it.builder, "image/jpeg", it.source, it.dest) })
+ * }
+ * ```
+ *
+ * @param signerFactory Creates a signer; all signers must be equivalent
+ * @param maxInFlight Maximum number of assets being signed, and TSA requests outstanding, at once
+ */
+class BatchSigner @JvmOverloads constructor(
+    private val signerFactory: () -> Signer,
+    val maxInFlight: Int = 8,
+) : Closeable {
+
+    /**
+     * One asset to sign. Each job needs its own [Builder] and streams.
+     *
+     * @property builder The builder holding the manifest definition
+     * @property format The MIME type of the asset
+     * @property source The input stream containing the asset
+     * @property dest The output stream for the signed asset
+     */
+    class Job(val builder: Builder, val format: String, val source: Stream, val dest: Stream)
+
+    /**
+     * Cumulative batch activity.
+     *
+     * @property signed Assets signed successfully
+     * @property failed Assets that failed to sign
+     * @property signers Signers created
+     * @property peakInFlight Largest number of assets signed at once
+     * @property averageSignMillis Mean time per asset, including the TSA round trip
+     */
+    data class Stats(
+        val signed: Long,
+        val failed: Long,
+        val signers: Int,
+        val peakInFlight: Int,
+        val averageSignMillis: Double,
+    )
+
+    private val idleSigners = ConcurrentLinkedQueue<Signer>()
+    private val createdSigners = ConcurrentLinkedQueue<Signer>()
+
+    private val inFlight = AtomicInteger()
+    private val peakInFlight = AtomicInteger()
+    private val signed = AtomicLong()
+    private val failed = AtomicLong()
+    private val signNanos = AtomicLong()
+
+    init {
+        require(maxInFlight > 0) { "maxInFlight must be positive" }
+    }
+
+    /**
+     * Signs every job, keeping up to [maxInFlight] in progress.
+     *
+     * A failure affects only its own job: any exception from signing, including a failing signer
+     * factory or a stream error, is returned as that job's result. Cancellation of the calling
+     * coroutine is not caught.
+     *
+     * @param jobs The assets to sign
+     * @param onResult Called from a worker thread as each job completes, with the job's index
+     * @return The result for each job, in the order of [jobs]
+     */
+    suspend fun signAll(
+        jobs: List<Job>,
+        onResult: ((index: Int, result: Result<Builder.SignResult>) -> Unit)? = null,
+    ): List<Result<Builder.SignResult>> = coroutineScope {
+        val permits = Semaphore(maxInFlight)
+        jobs.mapIndexed { index, job ->
+            // Signing blocks its thread for the whole TSA round trip, so run on the IO dispatcher
+            async(Dispatchers.IO) {
+                permits.withPermit {
+                    val result = try {
+                        Result.success(sign(job))
+                    } catch (e: CancellationException) {
+                        throw e
+                    } catch (e: Exception) {
+                        Result.failure(e)
+                    }
+                    onResult?.invoke(index, result)
+                    result
+                }
+            }
+        }.awaitAll()
+    }
+
+    /** Returns cumulative counters. */
+    fun stats(): Stats {
+        val done = signed.get() + failed.get()
+        return Stats(
+            signed = signed.get(),
+            failed = failed.get(),
+            signers = createdSigners.size,
+            peakInFlight = peakInFlight.get(),
+            averageSignMillis = if (done == 0L) 0.0 else signNanos.get() / 1e6 / done,
+        )
+    }
+
+    private fun sign(job: Job): Builder.SignResult {
+        val signer = idleSigners.poll() ?: signerFactory().also { createdSigners.add(it) }
+        peakInFlight.accumulateAndGet(inFlight.incrementAndGet(), ::maxOf)
+        val start = System.nanoTime()
+        try {
+            return job.builder.sign(job.format, job.source, job.dest, signer).also { signed.incrementAndGet() }
+        } catch (e: Exception) {
+            failed.incrementAndGet()
+            throw e
+        } finally {
+            signNanos.addAndGet(System.nanoTime() - start)
+            inFlight.decrementAndGet()
+            idleSigners.add(signer)
+        }
+    }
+
+    /** Closes every signer this batch signer created. */
+    override fun close() {
+        idleSigners.clear()
+        while (true) {
+            val signer = createdSigners.poll() ?: break
+            signer.close()
+        }
+    }
+}
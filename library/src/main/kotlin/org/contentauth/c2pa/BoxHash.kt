@@ -0,0 +1,374 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
+import java.io.ByteArrayOutputStream
+import java.security.MessageDigest
+import java.util.zip.CRC32
+
+/**
+ * Bounded memo of box hashes, shared across box-hashed signings.
+ *
+ * When an asset is signed again after an edit that touched only some of its boxes (a metadata
+ * segment, one PNG chunk), the hashes of the other boxes are taken from here. Entries are keyed
+ * by box name, length and CRC-32: a JPEG segment's CRC-32 is computed, which is much cheaper than
+ * its SHA-256, and a PNG chunk's is read from the chunk itself, so an unchanged PNG chunk is not
+ * read at all. CRC-32 detects edits but is not collision resistant, so share a cache only across
+ * assets whose content the signer controls. The least recently used entry is dropped once
+ * [maxEntries] is reached.
+ *
+ * @param maxEntries Maximum number of box hashes kept
+ */
+class BoxHashCache @JvmOverloads constructor(val maxEntries: Int = 4096) {
+
+    /**
+     * Cache activity.
+     *
+     * @property hits Boxes whose hash was reused
+     * @property misses Boxes that were hashed
+     * @property size Hashes currently cached
+     */
+    data class Stats(val hits: Long, val misses: Long, val size: Int)
+
+    private val entries = object : LinkedHashMap<String, ByteArray>(16, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<String, ByteArray>): Boolean =
+            size > maxEntries
+    }
+
+    private var hits = 0L
+    private var misses = 0L
+
+    init {
+        require(maxEntries > 0) { "maxEntries must be positive" }
+    }
+
+    /** Returns cumulative counters. */
+    @Synchronized
+    fun stats(): Stats = Stats(hits, misses, entries.size)
+
+    /** Drops every cached hash. */
+    @Synchronized
+    fun clear() {
+        entries.clear()
+    }
+
+    @Synchronized
+    internal fun get(key: String): ByteArray? =
+        entries[key].also { if (it != null) hits++ else misses++ }
+
+    @Synchronized
+    internal fun put(key: String, hash: ByteArray) {
+        entries[key] = hash
+    }
+}
+
+/**
+ * Box hashes (`c2pa.hash.boxes`), which bind an asset by hashing each top-level JPEG segment or
+ * PNG chunk separately rather than the whole file as one range.
+ *
+ * The boxes are read once, in order, and each is hashed on a worker, with up to a given number in
+ * flight. The manifest's own box is recorded by name only, so the hashes do not depend on where
+ * or how large the manifest is. A baseline JPEG keeps nearly all of its data in one scan segment,
+ * which is hashed by one worker; PNG image data split across many IDAT chunks, and progressive
+ * JPEG scans, spread across all of them.
+ *
+ * Each JPEG scan is buffered whole before it is hashed, and with a cache it is also passed over
+ * once for its CRC-32, so a large baseline scan costs its size in memory and a full read even
+ * when its hash is cached.
+ */
+internal object BoxHash {
+
+    const val LABEL = "c2pa.hash.boxes"
+
+    const val MANIFEST_BOX = "C2PA"
+
+    val FORMATS = setOf("image/jpeg", "image/png")
+
+    private const val ALGORITHM = "sha256"
+
+    private val PNG_SIGNATURE = byteArrayOf(0x89.toByte(), 'P'.code.toByte(), 'N'.code.toByte(), 'G'.code.toByte())
+
+    /**
+     * Hashes the boxes of [source], from its current position, and returns the assertion data.
+     * The manifest box is recorded where signing inserts the manifest, and any manifest already
+     * in [source] is left out since signing replaces it.
+     *
+     * @throws C2PAError.Api if [format] is not supported or the asset is malformed
+     */
+    suspend fun compute(format: String, source: Stream, cache: BoxHashCache?, parallelism: Int): JsonObject {
+        require(parallelism > 0) { "parallelism must be positive" }
+        if (format !in FORMATS) throw C2PAError.Api("Box hashing is not supported for $format")
+        val permits = Semaphore(parallelism)
+        val boxes = try {
+            coroutineScope {
+                val pending = mutableListOf<Pair<String, Deferred<ByteArray>>>()
+                val onBox: suspend (String, Box) -> Unit = { name, box ->
+                    pending += name to when (box) {
+                        is Box.Manifest -> CompletableDeferred(byteArrayOf(0))
+                        is Box.Cached -> CompletableDeferred(box.hash)
+                        is Box.Content -> {
+                            permits.acquire()
+                            async(Dispatchers.Default) {
+                                try {
+                                    hash(name, box, cache)
+                                } finally {
+                                    permits.release()
+                                }
+                            }
+                        }
+                    }
+                }
+                val reader = BoxReader(source)
+                if (format == "image/jpeg") readJpeg(reader, onBox) else readPng(reader, cache, onBox)
+                pending.map { it.first }.zip(pending.map { it.second }.awaitAll())
+            }
+        } catch (e: IllegalArgumentException) {
+            throw C2PAError.Api("Malformed $format: ${e.message}")
+        }
+        return JsonObject(mapOf("boxes" to JsonArray(boxes.map { (name, hash) -> boxMap(name, hash) })))
+    }
+
+    private sealed class Box {
+        object Manifest : Box()
+
+        class Cached(val hash: ByteArray) : Box()
+
+        /** A box to hash; [key] is set when its cache key is already known and was missed. */
+        class Content(val bytes: ByteArray, val key: String? = null) : Box()
+    }
+
+    private fun hash(name: String, box: Box.Content, cache: BoxHashCache?): ByteArray {
+        if (cache == null) return MessageDigest.getInstance("SHA-256").digest(box.bytes)
+        val key = box.key ?: cacheKey(name, box.bytes.size.toLong(), CRC32().apply { update(box.bytes) }.value)
+        if (box.key == null) cache.get(key)?.let { return it }
+        return MessageDigest.getInstance("SHA-256").digest(box.bytes).also { cache.put(key, it) }
+    }
+
+    private fun cacheKey(name: String, length: Long, crc: Long): String = "$name:$length:$crc"
+
+    private fun boxMap(name: String, hash: ByteArray): JsonObject =
+        JsonObject(
+            mapOf(
+                "names" to JsonArray(listOf(JsonPrimitive(name))),
+                "alg" to JsonPrimitive(ALGORITHM),
+                "hash" to JsonArray(hash.map { JsonPrimitive(it.toInt() and 0xFF) }),
+                "pad" to JsonArray(emptyList()),
+            ),
+        )
+
+    /**
+     * Reports JPEG segments in file order, each scan with its entropy-coded data. The manifest
+     * box goes after SOI, or after APP0 if that comes first, which is where signing inserts the
+     * manifest; C2PA APP11 segments already in the asset are replaced and so are not reported.
+     */
+    private suspend fun readJpeg(reader: BoxReader, onBox: suspend (String, Box) -> Unit) {
+        val soi = reader.readBytes(2)
+        require(soi[0] == 0xFF.toByte() && soi[1] == 0xD8.toByte()) { "not a JPEG" }
+        onBox("SOI", Box.Content(soi))
+        var manifestPlaced = false
+        var previous = "SOI"
+        while (true) {
+            val start = reader.position
+            require(reader.read() == 0xFF) { "invalid JPEG marker" }
+            var type = reader.read()
+            while (type == 0xFF) type = reader.read() // fill bytes
+            require(type >= 0) { "unexpected end of stream" }
+            val name = markerName(type)
+
+            if (!manifestPlaced && (previous == "APP0" || (previous == "SOI" && name != "APP0"))) {
+                onBox(MANIFEST_BOX, Box.Manifest)
+                manifestPlaced = true
+            }
+            if (type == 0xD9 || type == 0x01 || type in 0xD0..0xD7) {
+                onBox(name, Box.Content(reader.copy(start, reader.position)))
+                if (type == 0xD9) break
+                previous = name
+                continue
+            }
+
+            val length = (reader.read() shl 8) or reader.read()
+            require(length >= 2) { "invalid JPEG segment length" }
+            val body = reader.readBytes(length - 2)
+            if (type == 0xEB && body.size >= 2 && body[0] == 'J'.code.toByte() && body[1] == 'P'.code.toByte()) {
+                continue
+            }
+            val segment = reader.copy(start, reader.position - body.size) + body
+            onBox(name, Box.Content(if (type == 0xDA) reader.readScan(segment) else segment))
+            previous = name
+        }
+    }
+
+    /**
+     * Reports the PNG signature as `PNGh` and then each chunk by its type. The manifest box goes
+     * after IHDR, which is where signing inserts the manifest; a `caBX` chunk already in the
+     * asset is replaced and so is not reported. With a [cache], a chunk is looked up by its
+     * stored CRC and, when found, its data is skipped without being read.
+     */
+    private suspend fun readPng(reader: BoxReader, cache: BoxHashCache?, onBox: suspend (String, Box) -> Unit) {
+        val signature = reader.readBytes(8)
+        require(signature.copyOfRange(0, 4).contentEquals(PNG_SIGNATURE)) { "not a PNG" }
+        onBox("PNGh", Box.Content(signature))
+        while (true) {
+            val header = reader.readBytes(8)
+            val length = ((header[0].toLong() and 0xFF) shl 24) or ((header[1].toLong() and 0xFF) shl 16) or
+                ((header[2].toLong() and 0xFF) shl 8) or (header[3].toLong() and 0xFF)
+            require(length <= Int.MAX_VALUE - 12) { "PNG chunk too large" }
+            val type = String(header, 4, 4, Charsets.US_ASCII)
+            val chunkStart = reader.position - 8
+
+            when {
+                type == "caBX" -> reader.skip(length + 4)
+                cache == null -> onBox(type, Box.Content(header + reader.readBytes(length.toInt() + 4)))
+                else -> {
+                    reader.skip(length)
+                    val crc = reader.readBytes(4).fold(0L) { acc, b -> (acc shl 8) or (b.toLong() and 0xFF) }
+                    val key = cacheKey(type, length + 12, crc)
+                    val cached = cache.get(key)
+                    onBox(type, cached?.let { Box.Cached(it) } ?: Box.Content(reader.copy(chunkStart, reader.position), key))
+                }
+            }
+            if (type == "IHDR") onBox(MANIFEST_BOX, Box.Manifest)
+            if (type == "IEND") break
+        }
+    }
+
+    private fun markerName(type: Int): String =
+        when (type) {
+            0xD8 -> "SOI"
+            0xD9 -> "EOI"
+            0xDA -> "SOS"
+            0xDB -> "DQT"
+            0xC4 -> "DHT"
+            0xDD -> "DRI"
+            0xFE -> "COM"
+            in 0xE0..0xEF -> "APP${type - 0xE0}"
+            in 0xC0..0xCF -> "SOF${type - 0xC0}"
+            in 0xD0..0xD7 -> "RST${type - 0xD0}"
+            else -> "0x%02X".format(type)
+        }
+
+    /**
+     * Sequential reader over a [Stream] that tracks its position. Earlier bytes are re-read by
+     * seeking, which [copy] does only for short headers or for chunks that must be hashed.
+     */
+    private class BoxReader(private val stream: Stream) {
+        private val buffer = ByteArray(64 * 1024)
+        private var bufferStart = stream.seek(0, SeekMode.CURRENT.value)
+        private var index = 0
+        private var limit = 0
+
+        val position: Long get() = bufferStart + index
+
+        /** Returns the next byte, or -1 at the end of the stream. */
+        fun read(): Int {
+            if (index == limit && !fill()) return -1
+            return buffer[index++].toInt() and 0xFF
+        }
+
+        fun readBytes(count: Int): ByteArray {
+            val bytes = ByteArray(count)
+            var read = 0
+            while (read < count) {
+                if (index == limit) require(fill()) { "unexpected end of stream" }
+                val n = minOf(count - read, limit - index)
+                System.arraycopy(buffer, index, bytes, read, n)
+                index += n
+                read += n
+            }
+            return bytes
+        }
+
+        fun skip(count: Long) {
+            val target = position + count
+            if (target in bufferStart..bufferStart + limit) {
+                index = (target - bufferStart).toInt()
+            } else {
+                stream.seek(target, SeekMode.START.value)
+                bufferStart = target
+                index = 0
+                limit = 0
+            }
+        }
+
+        /** Returns the bytes from [from] until [until], leaving the position unchanged. */
+        fun copy(from: Long, until: Long): ByteArray {
+            if (from >= bufferStart && until <= bufferStart + limit) {
+                return buffer.copyOfRange((from - bufferStart).toInt(), (until - bufferStart).toInt())
+            }
+            val resume = position
+            stream.seek(from, SeekMode.START.value)
+            bufferStart = from
+            index = 0
+            limit = 0
+            val bytes = readBytes((until - from).toInt())
+            skip(resume - position)
+            return bytes
+        }
+
+        /**
+         * Reads entropy-coded scan data up to, but not including, the next marker other than a
+         * stuffed byte or a restart marker, and returns it after [header] in one array.
+         */
+        fun readScan(header: ByteArray): ByteArray {
+            val out = ByteArrayOutputStream(header.size + buffer.size).apply { write(header) }
+            var pendingMarker = false
+            while (true) {
+                if (index == limit) require(fill()) { "unexpected end of stream" }
+                if (pendingMarker) {
+                    // 0xFF ended the previous buffer
+                    val next = buffer[index].toInt() and 0xFF
+                    if (next != 0x00 && next !in 0xD0..0xD7) {
+                        skip(-1)
+                        return out.toByteArray()
+                    }
+                    out.write(0xFF)
+                    out.write(next)
+                    index++
+                    pendingMarker = false
+                    continue
+                }
+                var end = index
+                while (end < limit && buffer[end] != 0xFF.toByte()) end++
+                out.write(buffer, index, end - index)
+                index = end
+                if (end == limit) continue
+                if (end + 1 == limit) {
+                    index = limit
+                    pendingMarker = true
+                    continue
+                }
+                val next = buffer[end + 1].toInt() and 0xFF
+                if (next != 0x00 && next !in 0xD0..0xD7) return out.toByteArray()
+                out.write(buffer, end, 2)
+                index += 2
+            }
+        }
+
+        private fun fill(): Boolean {
+            bufferStart += limit
+            index = 0
+            limit = stream.read(buffer, buffer.size.toLong()).toInt().coerceAtLeast(0)
+            return limit > 0
+        }
+    }
+}
@@ -11,7 +11,16 @@ each license.
 
 package org.contentauth.c2pa
 
+import android.util.Log
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
+import kotlinx.serialization.json.int
+import kotlinx.serialization.json.jsonObject
+import kotlinx.serialization.json.longOrNull
 import java.io.Closeable
+import kotlin.concurrent.read
 import org.contentauth.c2pa.manifest.ManifestValidator
 
 /**
@@ -111,11 +120,35 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
      */
     data class SignResult(val size: Long, val manifestBytes: ByteArray?)
 
+    /**
+     * Result of [resign].
+     *
+     * @property size The size of the new manifest in bytes
+     * @property manifestBytes The new manifest as embedded in the asset, if available
+     * @property reusedHash Whether the previous data hash was reused; false if the asset was
+     * hashed again by a full [sign]
+     * @property fallbackReason Why the previous hash was not reused, or null if it was
+     */
+    data class ResignResult(
+        val size: Long,
+        val manifestBytes: ByteArray?,
+        val reusedHash: Boolean,
+        val fallbackReason: String? = null,
+    )
+
+    // Outcome of looking for a reusable data hash in a previously signed asset
+    private sealed class PreviousHash {
+        class Reusable(val range: LongRange, val dataHash: JsonObject) : PreviousHash()
+        class Rejected(val reason: String) : PreviousHash()
+    }
+
     companion object {
         init {
             loadC2PALibraries()
         }
 
+        private const val TAG = "C2PA"
+
         /**
          * Default assertion labels that are attributed to the signer (created assertions).
          *
@@ -217,7 +250,7 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
         @JvmStatic
         @Throws(C2PAError::class)
         fun fromArchive(archive: Stream): Builder = executeC2PAOperation("Failed to create builder from archive") {
-            val handle = nativeFromArchive(archive.rawPtr)
+            val handle = C2PA.globalSettingsLock.read { nativeFromArchive(archive.rawPtr) }
             if (handle == 0L) null else Builder(handle)
         }
 
@@ -288,6 +321,89 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
             return builder
         }
 
+        /**
+         * Signs a manifest that binds every file of a multi-file asset, such as a RAW+JPEG pair
+         * or an image sequence, with a collection data hash (`c2pa.hash.collection.data`).
+         *
+         * Not supported yet: this always throws. The native library signs only with a data,
+         * box or BMFF hash as the hard binding and does not accept a collection data hash in
+         * their place, and signing with a placeholder data hash beside it would produce a
+         * manifest with a second hard binding that binds nothing. Sign each member separately
+         * until the native library can sign and validate collections.
+         *
+         * @param manifestJSON The manifest definition as a JSON string
+         * @param members The files of the asset, each with a URI unique within the collection
+         * @param signer The [Signer] to use for signing
+         * @param parallelism Maximum number of members hashed at once
+         * @return The signed manifest store
+         * @throws C2PAError.Api always, until collection data hashes are supported natively
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        @Suppress("UNUSED_PARAMETER")
+        fun signCollection(
+            manifestJSON: String,
+            members: List<CollectionMember>,
+            signer: Signer,
+            parallelism: Int = Runtime.getRuntime().availableProcessors(),
+        ): ByteArray = throw C2PAError.Api(
+            "Collection data hashes cannot be signed: the native library does not accept them as a hard binding",
+        )
+
+        /**
+         * Signs a JPEG or PNG asset with a box hash (`c2pa.hash.boxes`) instead of a data hash.
+         *
+         * A data hash covers the asset as one range, hashed start to finish on one thread. A box
+         * hash covers each top-level segment or chunk separately: the boxes are hashed here, up
+         * to [parallelism] at once, and with a [cache], boxes unchanged since an earlier signing
+         * reuse their hashes, so re-signing after a small edit hashes only the edited boxes. The
+         * hashes are added to the definition as the manifest's only hard binding; the native
+         * library signs with it as supplied and does not hash the asset again.
+         *
+         * A JPEG's scan is held in memory while it is hashed, so peak memory grows with the
+         * size of the compressed image data. With a [cache], an unchanged JPEG segment still
+         * has its CRC-32 computed to find its cache key, so a warm cache saves the SHA-256 of the
+         * scan but not a full pass over it; unchanged PNG chunks are skipped without being read.
+         *
+         * @param manifestJSON The manifest definition as a JSON string
+         * @param format The MIME type of the asset, "image/jpeg" or "image/png"
+         * @param source The asset to sign
+         * @param dest The output stream for the signed asset
+         * @param signer The [Signer] to use for signing
+         * @param cache Box hashes kept across signings, if any
+         * @param parallelism Maximum number of boxes hashed at once
+         * @return A [SignResult] containing the manifest size and optional manifest bytes
+         * @throws C2PAError.Api if the format is unsupported, the asset is malformed, or signing
+         * fails
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        suspend fun signBoxHashed(
+            manifestJSON: String,
+            format: String,
+            source: Stream,
+            dest: Stream,
+            signer: Signer,
+            cache: BoxHashCache? = null,
+            parallelism: Int = Runtime.getRuntime().availableProcessors(),
+        ): SignResult {
+            source.seek(0, SeekMode.START.value)
+            val boxes = BoxHash.compute(format, source, cache, parallelism)
+            val definition = try {
+                C2PAJson.default.parseToJsonElement(manifestJSON).jsonObject
+            } catch (e: IllegalArgumentException) {
+                throw C2PAError.Api("Invalid manifest definition: ${e.message}")
+            }
+            val assertion = JsonObject(mapOf("label" to JsonPrimitive(BoxHash.LABEL), "data" to boxes))
+            val assertions = (definition["assertions"] as? JsonArray).orEmpty() + assertion
+            val json = JsonObject(definition + ("assertions" to JsonArray(assertions))).toString()
+
+            return fromJson(json).use {
+                source.seek(0, SeekMode.START.value)
+                it.sign(format, source, dest, signer)
+            }
+        }
+
         @JvmStatic private external fun nativeFromArchive(streamHandle: Long): Long
 
         @JvmStatic private external fun nativeFromContext(contextPtr: Long): Long
@@ -499,9 +615,130 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
         if (result.size < 0) {
             throw C2PAError.Api(C2PA.getError() ?: "Failed to sign")
         }
+        result.manifestBytes?.let { signer.reserveTracker.observe(it) }
         return result
     }
 
+    /**
+     * Re-signs an already signed asset, reusing its previous data hash when it matches a hash the
+     * caller holds for the media.
+     *
+     * Use this when only assertions change, such as an added action or updated metadata. The
+     * media is not hashed here, so the caller supplies [expectedHash]: the SHA-256 data hash it
+     * holds for the media bytes as they are now, for example one recorded when the asset was last
+     * written. Without it, this is the same as [sign].
+     *
+     * The previous active manifest's data hash assertion is read from [source]. The hash is reused
+     * only if that manifest's claim signature verifies against its embedded certificate, its
+     * single excluded range is exactly where the manifest is embedded, the stored hash equals
+     * [expectedHash], and the new manifest comes out the same size as the placeholder it was
+     * built for. Then only the claim and signature are built, and [dest] receives the media bytes
+     * around a new manifest at the same offset. Otherwise, or for formats other than JPEG and
+     * PNG, the asset is signed with [sign] and hashed in full; [ResignResult.fallbackReason] says
+     * why.
+     *
+     * @param format The MIME type of the asset (e.g., "image/jpeg", "image/png")
+     * @param source The previously signed asset
+     * @param dest The output stream for the re-signed asset
+     * @param signer The [Signer] to use for signing
+     * @param expectedHash The data hash the caller holds for the media bytes as they are now
+     * @return A [ResignResult] reporting whether the hash was reused, and why not
+     * @throws C2PAError.Api if signing fails
+     */
+    @JvmOverloads
+    @Throws(C2PAError::class)
+    fun resign(
+        format: String,
+        source: Stream,
+        dest: Stream,
+        signer: Signer,
+        expectedHash: ByteArray? = null,
+    ): ResignResult {
+        val previous = if (expectedHash != null) {
+            previousDataHash(format, source, expectedHash)
+        } else {
+            PreviousHash.Rejected("No expected hash was given")
+        }
+        val fallbackReason = when (previous) {
+            is PreviousHash.Rejected -> previous.reason
+            is PreviousHash.Reusable -> {
+                val range = previous.range
+                val placeholder = dataHashedPlaceholder(signer.reserveSize().toLong(), format)
+            val exclusion = JsonObject(
+                mapOf("start" to JsonPrimitive(range.first), "length" to JsonPrimitive(placeholder.size)),
+            )
+                val updated = JsonObject(previous.dataHash + ("exclusions" to JsonArray(listOf(exclusion))))
+                val manifest = signDataHashedEmbeddable(signer, updated.toString(), format)
+                // The exclusion was fixed before signing, so it must match the manifest's final size
+                if (manifest.size == placeholder.size) {
+                    copyRange(source, 0, range.first, dest)
+                    dest.write(manifest, manifest.size.toLong())
+                    copyRange(source, range.last + 1, Long.MAX_VALUE, dest)
+                    return ResignResult(manifest.size.toLong(), manifest, reusedHash = true)
+                }
+                "New manifest is ${manifest.size} bytes, not the ${placeholder.size} reserved for it"
+            }
+        }
+        Log.i(TAG, "Re-signing with a full hash: $fallbackReason")
+        source.seek(0, SeekMode.START.value)
+        val result = sign(format, source, dest, signer)
+        return ResignResult(result.size, result.manifestBytes, reusedHash = false, fallbackReason = fallbackReason)
+    }
+
+    /**
+     * Returns the embedded range of [source]'s manifest store and the active manifest's data
+     * hash assertion if that hash equals [expectedHash] and can be reused for a manifest at the
+     * same offset, or why not.
+     */
+    private fun previousDataHash(format: String, source: Stream, expectedHash: ByteArray): PreviousHash {
+        val range = ClaimSignatureVerifier.locateManifestStore(format, source)
+            ?: return PreviousHash.Rejected("No embedded manifest store found in $format asset")
+        val store = ClaimSignatureVerifier.extractManifestStore(format, source)
+            ?: return PreviousHash.Rejected("Manifest store could not be read")
+        val claim = ClaimSignatureVerifier.verify(store)
+        if (!claim.intact) return PreviousHash.Rejected("Previous claim is not intact: ${claim.message}")
+
+        val active = ClaimSignatureVerifier.manifests(store).values.lastOrNull()
+            ?: return PreviousHash.Rejected("Manifest store has no active manifest")
+        val manifest = store.copyOfRange(active.first, active.last + 1)
+        val dataHash = try {
+            CoseSignatureLayout.lastCborBox(manifest, "c2pa.hash.data")?.let { box ->
+                C2PACbor.decodeToJsonElement(manifest.copyOfRange(box.first, box.last + 1)) as? JsonObject
+            }
+        } catch (e: SerializationException) {
+            null
+        } catch (e: IllegalArgumentException) {
+            null
+        } ?: return PreviousHash.Rejected("Active manifest has no readable data hash assertion")
+
+        val exclusion = (dataHash["exclusions"] as? JsonArray)?.singleOrNull() as? JsonObject
+            ?: return PreviousHash.Rejected("Data hash does not have exactly one exclusion")
+        val start = (exclusion["start"] as? JsonPrimitive)?.longOrNull
+        val length = (exclusion["length"] as? JsonPrimitive)?.longOrNull
+        if (start != range.first || length != range.last - range.first + 1) {
+            return PreviousHash.Rejected("Data hash exclusion does not match the embedded manifest")
+        }
+
+        val hash = (dataHash["hash"] as? JsonArray)?.map { (it as JsonPrimitive).int.toByte() }?.toByteArray()
+        if (hash == null || !hash.contentEquals(expectedHash)) {
+            return PreviousHash.Rejected("Stored data hash does not match the expected hash")
+        }
+        return PreviousHash.Reusable(range, dataHash)
+    }
+
+    /** Copies up to [count] bytes of [source], starting at [from], to [dest]. */
+    private fun copyRange(source: Stream, from: Long, count: Long, dest: Stream) {
+        source.seek(from, SeekMode.START.value)
+        val buffer = ByteArray(256 * 1024)
+        var remaining = count
+        while (remaining > 0) {
+            val n = source.read(buffer, minOf(buffer.size.toLong(), remaining))
+            if (n <= 0) break
+            dest.write(buffer, n)
+            remaining -= n
+        }
+    }
+
     /**
      * Creates a data-hashed placeholder for deferred signing workflows.
      *
@@ -509,7 +746,8 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
      * the final signature is applied. Use [signDataHashedEmbeddable] to produce the
      * final signed manifest after computing the asset's data hash.
      *
-     * @param reservedSize The number of bytes to reserve for the manifest
+     * @param reservedSize The number of bytes to reserve for the signature, typically
+     * [Signer.adaptiveReserveSize] or [Signer.reserveSize]
      * @param format The MIME type of the asset (e.g., "image/jpeg")
      * @return The placeholder manifest as a byte array
      * @throws C2PAError.Api if the placeholder cannot be created
@@ -554,6 +792,7 @@ class Builder internal constructor(private var ptr: Long) : Closeable {
         if (result == null) {
             throw C2PAError.Api(C2PA.getError() ?: "Failed to sign with data hash")
         }
+        signer.reserveTracker.observe(result)
         return result
     }
 
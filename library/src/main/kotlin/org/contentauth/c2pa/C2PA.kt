@@ -13,12 +13,21 @@ each license.
 package org.contentauth.c2pa
 
 import java.io.File
+import java.io.IOException
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
 
 /**
  * Main C2PA object for static operations
  *
  * The native libraries are automatically loaded when this object is first accessed.
  * No manual initialization is required.
+ *
+ * Settings loaded with [loadSettings] are compiled into a process-default [C2PAContext] that
+ * backs [readFile] and [Reader.fromStream], so those calls never read process-wide native state.
+ * Code that needs different settings per tenant or per operation should create its own
+ * [C2PAContext] or [SharedC2PAContext] instead.
  */
 object C2PA {
     init {
@@ -37,6 +46,28 @@ object C2PA {
     @JvmStatic
     external fun getError(): String?
 
+    /** The context behind the convenience APIs, replaced whenever settings are loaded. */
+    internal val defaultContext: SharedC2PAContext by lazy { SharedC2PAContext.create() }
+
+    /** The signature cache of the current [defaultContext], keyed by its trust settings. */
+    internal val defaultSignatureScope: SignatureVerificationCache.Scope
+        get() = defaultContext.withCurrentContext { it.signatureScope }
+
+    /**
+     * Guards the native process-wide settings. Loading settings takes the write lock; native
+     * calls that read them (the path-based APIs here, [Builder.fromArchive],
+     * [Reader.fromManifestAndStream], [ParsedManifestStore.bind] and the settings-based signer)
+     * take the read lock, so they never observe a half-applied load.
+     */
+    internal val globalSettingsLock = ReentrantReadWriteLock()
+
+    /**
+     * Loads [settings] into the native process-wide settings only, leaving [defaultContext]
+     * alone. Returns the native result code (0 for success).
+     */
+    internal fun loadNativeSettings(settings: String, format: String): Int =
+        globalSettingsLock.write { loadSettingsNative(settings, format) }
+
     @JvmStatic
     private external fun loadSettingsNative(settings: String, format: String): Int
 
@@ -45,7 +76,15 @@ object C2PA {
      * Returns the result code from the native call (0 for success).
      */
     @JvmStatic
-    fun loadSettingsResult(settings: String, format: String): Int = loadSettingsNative(settings, format)
+    fun loadSettingsResult(settings: String, format: String): Int {
+        try {
+            defaultContext.replace(settings, format)
+        } catch (e: C2PAError) {
+            return -1
+        }
+        // The path-based APIs below have no context variant and still read the native settings
+        return loadNativeSettings(settings, format)
+    }
 
     /**
      * Load settings from a string
@@ -53,7 +92,7 @@ object C2PA {
     @Throws(C2PAError::class)
     fun loadSettings(settings: String, format: String) {
         executeC2PAOperation("Failed to load settings") {
-            val result = loadSettingsNative(settings, format)
+            val result = loadSettingsResult(settings, format)
             if (result < 0) null else Unit
         }
     }
@@ -63,10 +102,28 @@ object C2PA {
 
     /**
      * Read a manifest store from a file
+     *
+     * Without a [dataDir] the file is read through the process-default context. Extracting
+     * resources into [dataDir] still uses the native path-based reader.
      */
     @Throws(C2PAError::class)
-    fun readFile(path: String, dataDir: String? = null): String = executeC2PAOperation("Failed to read file") {
-        readFileNative(path, dataDir)
+    fun readFile(path: String, dataDir: String? = null): String {
+        if (dataDir != null) {
+            return executeC2PAOperation("Failed to read file") {
+                globalSettingsLock.read { readFileNative(path, dataDir) }
+            }
+        }
+        val file = File(path)
+        val stream = try {
+            FileStream(file, FileStream.Mode.READ, createIfNeeded = false)
+        } catch (e: IOException) {
+            throw C2PAError.Api("Failed to read file: ${e.message}")
+        }
+        return stream.use {
+            defaultContext.withCurrentContext { Reader.fromContext(it) }
+                .withStream(file.extension.lowercase(), it)
+                .use { reader -> reader.json() }
+        }
     }
 
     @JvmStatic
@@ -78,7 +135,7 @@ object C2PA {
     @Throws(C2PAError::class)
     fun readIngredientFile(path: String, dataDir: String? = null): String =
         executeC2PAOperation("Failed to read ingredient file") {
-            readIngredientFileNative(path, dataDir)
+            globalSettingsLock.read { readIngredientFileNative(path, dataDir) }
         }
 
     @JvmStatic
@@ -104,16 +161,18 @@ object C2PA {
         signerInfo: SignerInfo,
         dataDir: String? = null,
     ): String = executeC2PAOperation("Failed to sign file") {
-        signFileNative(
-            sourcePath,
-            destPath,
-            manifest,
-            signerInfo.algorithm.description,
-            signerInfo.certificatePEM,
-            signerInfo.privateKeyPEM,
-            signerInfo.tsaURL,
-            dataDir,
-        )
+        globalSettingsLock.read {
+            signFileNative(
+                sourcePath,
+                destPath,
+                manifest,
+                signerInfo.algorithm.description,
+                signerInfo.certificatePEM,
+                signerInfo.privateKeyPEM,
+                signerInfo.tsaURL,
+                dataDir,
+            )
+        }
     }
 
     @JvmStatic
@@ -121,6 +180,8 @@ object C2PA {
 
     /**
      * Sign data using Ed25519
+     *
+     * The key is parsed on every call; use [Ed25519Key] when signing many payloads with one key.
      */
     @Throws(C2PAError::class)
     fun ed25519Sign(data: ByteArray, privateKey: String): ByteArray =
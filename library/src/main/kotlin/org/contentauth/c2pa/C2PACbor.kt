@@ -0,0 +1,339 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlinx.serialization.DeserializationStrategy
+import kotlinx.serialization.ExperimentalSerializationApi
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.SerializationStrategy
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonElement
+import kotlinx.serialization.json.JsonNull
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
+import kotlinx.serialization.json.JsonUnquotedLiteral
+import kotlinx.serialization.serializer
+import java.io.ByteArrayOutputStream
+import java.math.BigInteger
+
+/**
+ * Binary (CBOR, RFC 8949) encoding for C2PA manifests and manifest model classes.
+ *
+ * CBOR carries the same data model as the JSON accepted and produced by the C2PA core, so any
+ * `@Serializable` model in [org.contentauth.c2pa.manifest] can be encoded with it. Values are
+ * serialized through [C2PAJson.default] into a [JsonElement] tree, which keeps the custom
+ * JSON-aware serializers (such as those for assertions) working, and the tree is then written
+ * directly as CBOR without producing JSON text.
+ *
+ * The C2PA C API accepts and returns only JSON, so there is no CBOR path into the native
+ * builder; CBOR is for storing and transmitting models compactly, and for [Reader.cbor], whose
+ * output is transcoded natively from the reader's JSON.
+ *
+ * ```kotlin
+ * val cbor = manifest.toCbor()
+ * val restored = ManifestDefinition.fromCbor(cbor)
+ *
+ * val store = C2PACbor.decodeToJsonElement(reader.cbor())
+ * ```
+ */
+object C2PACbor {
+
+    private const val MAJOR_UNSIGNED = 0
+    private const val MAJOR_NEGATIVE = 1
+    private const val MAJOR_BYTES = 2
+    private const val MAJOR_TEXT = 3
+    private const val MAJOR_ARRAY = 4
+    private const val MAJOR_MAP = 5
+    private const val MAJOR_TAG = 6
+    private const val MAJOR_SIMPLE = 7
+
+    private const val INDEFINITE = -1L
+    private const val MAX_DEPTH = 512
+
+    /**
+     * Encodes [value] as CBOR using the given [serializer].
+     *
+     * @throws SerializationException if the value cannot be serialized.
+     */
+    fun <T> encodeToByteArray(serializer: SerializationStrategy<T>, value: T): ByteArray =
+        encodeToByteArray(C2PAJson.default.encodeToJsonElement(serializer, value))
+
+    /**
+     * Decodes a value of type [T] from CBOR using the given [deserializer].
+     *
+     * @throws SerializationException if the bytes are not valid CBOR or do not match [T].
+     */
+    fun <T> decodeFromByteArray(deserializer: DeserializationStrategy<T>, bytes: ByteArray): T =
+        C2PAJson.default.decodeFromJsonElement(deserializer, decodeToJsonElement(bytes))
+
+    /** Encodes [value] as CBOR using its default serializer. */
+    inline fun <reified T> encodeToByteArray(value: T): ByteArray =
+        encodeToByteArray(serializer<T>(), value)
+
+    /** Decodes a value of type [T] from CBOR using its default serializer. */
+    inline fun <reified T> decodeFromByteArray(bytes: ByteArray): T =
+        decodeFromByteArray(serializer<T>(), bytes)
+
+    /** Encodes a JSON element tree as a single CBOR data item. */
+    fun encodeToByteArray(element: JsonElement): ByteArray {
+        val out = ByteArrayOutputStream(256)
+        writeElement(out, element)
+        return out.toByteArray()
+    }
+
+    /**
+     * Decodes a single CBOR data item into a JSON element tree.
+     *
+     * Byte strings become arrays of numbers, tags are skipped, and integer map keys become
+     * strings, matching how the C2PA core renders the same values as JSON.
+     *
+     * @throws SerializationException if the bytes are not a single well-formed CBOR item or
+     * contain values with no JSON equivalent.
+     */
+    fun decodeToJsonElement(bytes: ByteArray): JsonElement = decodeToJsonElement(bytes, 0, bytes.size)
+
+    /** Decodes the single CBOR data item stored in `bytes[from until to]`. */
+    internal fun decodeToJsonElement(bytes: ByteArray, from: Int, to: Int): JsonElement {
+        val reader = CborReader(bytes, from, to)
+        val element = reader.readElement(0)
+        if (reader.position != to) {
+            throw SerializationException("Unexpected trailing data after CBOR item")
+        }
+        return element
+    }
+
+    private fun writeHead(out: ByteArrayOutputStream, major: Int, value: Long) {
+        val type = major shl 5
+        when {
+            value in 0..23 -> out.write(type or value.toInt())
+            value in 0..0xFF -> {
+                out.write(type or 24)
+                out.write(value.toInt())
+            }
+            value in 0..0xFFFF -> {
+                out.write(type or 25)
+                writeBigEndian(out, value, 2)
+            }
+            value in 0..0xFFFFFFFFL -> {
+                out.write(type or 26)
+                writeBigEndian(out, value, 4)
+            }
+            else -> {
+                // Treated as unsigned, so values above Long.MAX_VALUE arrive here as negatives
+                out.write(type or 27)
+                writeBigEndian(out, value, 8)
+            }
+        }
+    }
+
+    private fun writeBigEndian(out: ByteArrayOutputStream, value: Long, byteCount: Int) {
+        for (i in byteCount - 1 downTo 0) {
+            out.write((value ushr (8 * i)).toInt() and 0xFF)
+        }
+    }
+
+    private fun writeText(out: ByteArrayOutputStream, text: String) {
+        val utf8 = text.encodeToByteArray()
+        writeHead(out, MAJOR_TEXT, utf8.size.toLong())
+        out.write(utf8, 0, utf8.size)
+    }
+
+    private fun writeElement(out: ByteArrayOutputStream, element: JsonElement) {
+        when (element) {
+            is JsonNull -> out.write(0xF6)
+            is JsonObject -> {
+                writeHead(out, MAJOR_MAP, element.size.toLong())
+                for ((key, value) in element) {
+                    writeText(out, key)
+                    writeElement(out, value)
+                }
+            }
+            is JsonArray -> {
+                writeHead(out, MAJOR_ARRAY, element.size.toLong())
+                element.forEach { writeElement(out, it) }
+            }
+            is JsonPrimitive -> writePrimitive(out, element)
+        }
+    }
+
+    private fun writePrimitive(out: ByteArrayOutputStream, primitive: JsonPrimitive) {
+        val content = primitive.content
+        if (primitive.isString) {
+            writeText(out, content)
+            return
+        }
+        when (content) {
+            "true" -> out.write(0xF5)
+            "false" -> out.write(0xF4)
+            else -> {
+                val long = content.toLongOrNull()
+                val unsigned = if (long == null) content.toULongOrNull() else null
+                when {
+                    long != null && long >= 0 -> writeHead(out, MAJOR_UNSIGNED, long)
+                    long != null -> writeHead(out, MAJOR_NEGATIVE, -1 - long)
+                    unsigned != null -> writeHead(out, MAJOR_UNSIGNED, unsigned.toLong())
+                    else -> {
+                        val double = content.toDoubleOrNull()
+                            ?: throw SerializationException("Invalid JSON number: $content")
+                        out.write(0xFB)
+                        writeBigEndian(out, double.toRawBits(), 8)
+                    }
+                }
+            }
+        }
+    }
+
+    private class CborReader(private val bytes: ByteArray, start: Int, private val limit: Int) {
+        var position = start
+
+        private var major = 0
+        private var info = 0
+
+        private fun readByte(): Int {
+            if (position >= limit) throw SerializationException("Unexpected end of CBOR data")
+            return bytes[position++].toInt() and 0xFF
+        }
+
+        /** Reads an item head, returning its argument or [INDEFINITE]. */
+        private fun readHead(): Long {
+            val initial = readByte()
+            major = initial ushr 5
+            info = initial and 0x1F
+            return when {
+                info < 24 -> info.toLong()
+                info == 31 -> INDEFINITE
+                info > 27 -> throw SerializationException("Invalid CBOR additional info: $info")
+                else -> {
+                    var value = 0L
+                    repeat(1 shl (info - 24)) { value = (value shl 8) or readByte().toLong() }
+                    value
+                }
+            }
+        }
+
+        private fun atBreak(): Boolean {
+            if (position < limit && bytes[position] == 0xFF.toByte()) {
+                position++
+                return true
+            }
+            return false
+        }
+
+        private fun readLength(value: Long): Int {
+            if (value < 0 || value > limit - position) {
+                throw SerializationException("CBOR length exceeds available data")
+            }
+            return value.toInt()
+        }
+
+        private fun readString(type: Int, length: Long, sink: ByteArrayOutputStream) {
+            if (length == INDEFINITE) {
+                while (!atBreak()) {
+                    val chunkLength = readHead()
+                    if (major != type || chunkLength == INDEFINITE) {
+                        throw SerializationException("Invalid chunk in indefinite-length CBOR string")
+                    }
+                    readString(type, chunkLength, sink)
+                }
+                return
+            }
+            val size = readLength(length)
+            sink.write(bytes, position, size)
+            position += size
+        }
+
+        // Arguments above Long.MAX_VALUE arrive as negative longs and are widened as unsigned
+        @OptIn(ExperimentalSerializationApi::class)
+        private fun unsigned(value: Long): JsonPrimitive =
+            if (value >= 0) JsonPrimitive(value) else JsonUnquotedLiteral(value.toULong().toString())
+
+        @OptIn(ExperimentalSerializationApi::class)
+        private fun negative(value: Long): JsonPrimitive =
+            if (value >= 0) {
+                JsonPrimitive(-1 - value)
+            } else {
+                JsonUnquotedLiteral(BigInteger(value.toULong().toString()).inc().negate().toString())
+            }
+
+        fun readElement(depth: Int): JsonElement {
+            if (depth > MAX_DEPTH) throw SerializationException("CBOR nesting is too deep")
+
+            var value = readHead()
+            while (major == MAJOR_TAG) {
+                if (value == INDEFINITE) throw SerializationException("Invalid CBOR tag")
+                value = readHead()
+            }
+
+            return when (major) {
+                MAJOR_UNSIGNED, MAJOR_NEGATIVE -> {
+                    if (info == 31) {
+                        throw SerializationException("Invalid indefinite-length CBOR integer")
+                    }
+                    if (major == MAJOR_UNSIGNED) unsigned(value) else negative(value)
+                }
+                MAJOR_BYTES -> {
+                    val sink = ByteArrayOutputStream()
+                    readString(MAJOR_BYTES, value, sink)
+                    JsonArray(sink.toByteArray().map { JsonPrimitive(it.toInt() and 0xFF) })
+                }
+                MAJOR_TEXT -> {
+                    val sink = ByteArrayOutputStream()
+                    readString(MAJOR_TEXT, value, sink)
+                    JsonPrimitive(sink.toString(Charsets.UTF_8.name()))
+                }
+                MAJOR_ARRAY -> {
+                    val items = ArrayList<JsonElement>(if (value == INDEFINITE) 8 else readLength(value))
+                    var index = 0L
+                    while (if (value == INDEFINITE) !atBreak() else index++ < value) {
+                        items.add(readElement(depth + 1))
+                    }
+                    JsonArray(items)
+                }
+                MAJOR_MAP -> {
+                    val entries = LinkedHashMap<String, JsonElement>()
+                    var index = 0L
+                    while (if (value == INDEFINITE) !atBreak() else index++ < value) {
+                        val key = readElement(depth + 1)
+                        val isIntegerKey = key is JsonPrimitive && key.content.toBigIntegerOrNull() != null
+                        if (key !is JsonPrimitive || key is JsonNull || !(key.isString || isIntegerKey)) {
+                            throw SerializationException("CBOR map keys must be strings or integers")
+                        }
+                        entries[key.content] = readElement(depth + 1)
+                    }
+                    JsonObject(entries)
+                }
+                MAJOR_SIMPLE -> when (info) {
+                    20 -> JsonPrimitive(false)
+                    21 -> JsonPrimitive(true)
+                    22, 23 -> JsonNull
+                    25 -> JsonPrimitive(halfToDouble(value.toInt()))
+                    26 -> JsonPrimitive(Float.fromBits(value.toInt()).toDouble())
+                    27 -> JsonPrimitive(Double.fromBits(value))
+                    else -> throw SerializationException("Unsupported CBOR simple value: $info")
+                }
+                else -> throw SerializationException("Invalid CBOR major type: $major")
+            }
+        }
+
+        private fun halfToDouble(half: Int): Double {
+            val exponent = (half shr 10) and 0x1F
+            val mantissa = half and 0x3FF
+            val magnitude = when (exponent) {
+                0 -> Math.scalb(mantissa.toDouble(), -24)
+                31 -> if (mantissa == 0) Double.POSITIVE_INFINITY else Double.NaN
+                else -> Math.scalb((mantissa + 1024).toDouble(), exponent - 25)
+            }
+            return if (half and 0x8000 != 0) -magnitude else magnitude
+        }
+    }
+}
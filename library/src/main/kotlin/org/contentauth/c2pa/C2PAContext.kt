@@ -12,6 +12,7 @@ each license.
 
 package org.contentauth.c2pa
 
+import kotlinx.serialization.json.JsonObject
 import java.io.Closeable
 
 /**
@@ -79,21 +80,68 @@ class C2PAContext internal constructor(internal var ptr: Long) : Closeable {
          *
          * The settings are cloned internally, so the caller retains ownership of [settings].
          *
+         * With a [revocationIndex], readers created from this context check the signing
+         * certificate chain of the active manifest against it and report the result in
+         * [Reader.revocationCheck], without network access.
+         *
          * @param settings The settings to configure this context with
+         * @param revocationIndex Offline revocation data for readers, or null for none
+         * @param signatureCache Memo of claim signature checks for this context; see
+         * [C2PAContext.signatureCache]
          * @return A new [C2PAContext] configured with the provided settings
          * @throws C2PAError.Api if the context cannot be created with the given settings
          */
         @JvmStatic
+        @JvmOverloads
         @Throws(C2PAError::class)
-        fun fromSettings(settings: C2PASettings): C2PAContext = executeC2PAOperation("Failed to create C2PAContext with settings") {
-            val handle = nativeNewWithSettings(settings.ptr)
-            if (handle == 0L) null else C2PAContext(handle)
-        }
+        fun fromSettings(
+            settings: C2PASettings,
+            revocationIndex: RevocationIndex? = null,
+            signatureCache: SignatureVerificationCache = SignatureVerificationCache(),
+        ): C2PAContext =
+            executeC2PAOperation("Failed to create C2PAContext with settings") {
+                val handle = nativeNewWithSettings(settings.ptr)
+                if (handle == 0L) {
+                    null
+                } else {
+                    C2PAContext(handle).also {
+                        it.signerSections = settings.signerSections
+                        it.revocationIndex = revocationIndex
+                        it.signatureCache = signatureCache
+                        it.trustKey = SignatureVerificationCache.trustKey(settings.trustSettings)
+                    }
+                }
+            }
 
         @JvmStatic private external fun nativeNew(): Long
         @JvmStatic private external fun nativeNewWithSettings(settingsPtr: Long): Long
     }
 
+    /** Signer sections of the settings this context was created from, for [Signer.fromContext]. */
+    internal var signerSections: JsonObject = JsonObject(emptyMap())
+        private set
+
+    /**
+     * Memo of the claim signature checks made by the Kotlin signature-only path under this
+     * context's settings: [Reader.fromStream] below [VerificationLevel.FULL],
+     * [Reader.checkIngredientClaimSignatures] and [ParsedManifestStore.integrityCheck]. Results
+     * are keyed by this context's trust settings as well as the signature, so a cache passed to
+     * several contexts never answers one with a result made under another's trust
+     * configuration. Full validation runs in the native library and never consults it.
+     */
+    var signatureCache: SignatureVerificationCache = SignatureVerificationCache()
+        private set
+
+    // Canonical trust settings of this context, part of every signatureCache key
+    private var trustKey: ByteArray = SignatureVerificationCache.trustKey(JsonObject(emptyMap()))
+
+    internal val signatureScope: SignatureVerificationCache.Scope
+        get() = SignatureVerificationCache.Scope(signatureCache, trustKey)
+
+    /** The revocation index readers created from this context check against, if any. */
+    var revocationIndex: RevocationIndex? = null
+        private set
+
     override fun close() {
         if (ptr != 0L) {
             free(ptr)
@@ -12,6 +12,11 @@ each license.
 
 package org.contentauth.c2pa
 
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonElement
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
 import org.contentauth.c2pa.settings.C2PASettingsDefinition
 import java.io.Closeable
 
@@ -73,8 +78,30 @@ class C2PASettings internal constructor(internal var ptr: Long) : Closeable {
             create().updateFrom(definition)
 
         @JvmStatic private external fun nativeNew(): Long
+
+        /** Top-level sections tracked for [Signer.fromContext]. */
+        internal val SIGNER_SECTIONS = setOf("signer", "cawg_x509_signer")
+
+        /** Top-level section tracked for keying [SignatureVerificationCache] results. */
+        internal const val TRUST_SECTION = "trust"
     }
 
+    /**
+     * The signer sections applied through JSON updates, kept so that [Signer.fromContext] can
+     * build a signer without loading them into the process-wide settings. Sections supplied as
+     * TOML are not tracked.
+     */
+    internal var signerSections: JsonObject = JsonObject(emptyMap())
+        private set
+
+    /**
+     * The trust configuration applied so far, which a [C2PAContext] folds into the keys of its
+     * [SignatureVerificationCache]. TOML cannot be inspected here, so each TOML string is
+     * recorded whole.
+     */
+    internal var trustSettings: JsonObject = JsonObject(emptyMap())
+        private set
+
     /**
      * Updates settings from a JSON or TOML string.
      *
@@ -89,6 +116,19 @@ class C2PASettings internal constructor(internal var ptr: Long) : Closeable {
         if (result < 0) {
             throw C2PAError.Api(C2PA.getError() ?: "Failed to update settings from string")
         }
+        if (format.equals("json", ignoreCase = true)) {
+            val root = try {
+                C2PAJson.default.parseToJsonElement(settingsStr) as? JsonObject
+            } catch (e: SerializationException) {
+                null
+            }
+            val sections = root?.filterKeys { it in SIGNER_SECTIONS }.orEmpty()
+            if (sections.isNotEmpty()) signerSections = JsonObject(signerSections + sections)
+            (root?.get(TRUST_SECTION) as? JsonObject)?.let { trustSettings = JsonObject(trustSettings + it) }
+        } else {
+            val recorded = (trustSettings["toml"] as? JsonArray).orEmpty()
+            trustSettings = JsonObject(trustSettings + ("toml" to JsonArray(recorded + JsonPrimitive(settingsStr))))
+        }
         return this
     }
 
@@ -117,9 +157,62 @@ class C2PASettings internal constructor(internal var ptr: Long) : Closeable {
         if (result < 0) {
             throw C2PAError.Api(C2PA.getError() ?: "Failed to set settings value")
         }
+        trackValue(path, value)
         return this
     }
 
+    /**
+     * Sets several configuration values in a single native call.
+     *
+     * Values are applied in iteration order. This avoids one JNI transition per value when
+     * applying a batch of changes, such as a trust-list or TSA update.
+     *
+     * @param values Map of dot-separated paths to JSON values as strings, as for [setValue]
+     * @return This settings instance for fluent chaining
+     * @throws C2PAError.Api if any path or value is invalid. Values before the rejected one
+     * have already been applied.
+     *
+     * @sample
+     * ```kotlin
+     * settings.setValues(
+     *     mapOf(
+     *         "verify.verify_trust" to "true",
+     *         "verify.ocsp_fetch" to "false",
+     *     ),
+     * )
+     * ```
+     */
+    @Throws(C2PAError::class)
+    fun setValues(values: Map<String, String>): C2PASettings {
+        if (values.isEmpty()) return this
+        val result = setValuesNative(ptr, values.keys.toTypedArray(), values.values.toTypedArray())
+        if (result < 0) {
+            throw C2PAError.Api(C2PA.getError() ?: "Failed to set settings values")
+        }
+        values.forEach { (path, value) -> trackValue(path, value) }
+        return this
+    }
+
+    private fun trackValue(path: String, value: String) {
+        val segments = path.split('.')
+        when {
+            segments.first() in SIGNER_SECTIONS ->
+                signerSections = withValue(signerSections, segments, C2PAJson.default.parseToJsonElement(value))
+            segments.first() == TRUST_SECTION && segments.size > 1 ->
+                trustSettings = withValue(trustSettings, segments.drop(1), C2PAJson.default.parseToJsonElement(value))
+        }
+    }
+
+    private fun withValue(target: JsonObject, segments: List<String>, value: JsonElement): JsonObject {
+        val key = segments.first()
+        val updated = if (segments.size == 1) {
+            value
+        } else {
+            withValue(target[key] as? JsonObject ?: JsonObject(emptyMap()), segments.drop(1), value)
+        }
+        return JsonObject(target + (key to updated))
+    }
+
     override fun close() {
         if (ptr != 0L) {
             free(ptr)
@@ -130,4 +223,5 @@ class C2PASettings internal constructor(internal var ptr: Long) : Closeable {
     private external fun free(handle: Long)
     private external fun updateFromStringNative(handle: Long, settingsStr: String, format: String): Int
     private external fun setValueNative(handle: Long, path: String, value: String): Int
+    private external fun setValuesNative(handle: Long, paths: Array<String>, values: Array<String>): Int
 }
@@ -0,0 +1,291 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.CoroutineStart
+import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.async
+import kotlinx.coroutines.cancel
+import java.io.ByteArrayInputStream
+import java.io.Closeable
+import java.io.File
+import java.io.IOException
+import java.net.URLEncoder
+import java.security.cert.CertificateException
+import java.security.cert.CertificateFactory
+import java.security.cert.X509Certificate
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Keeps enrolled certificates for signing keys and renews them before they expire.
+ *
+ * [CertificateManager.createSignerWithCSR] performs a CSR round trip every time it is called. This
+ * manager instead persists each issued chain in [storageDir], keyed by key alias, and builds
+ * signers from the stored chain immediately. Once less than [renewalFraction] of a certificate's
+ * validity remains, the next [signer] call still returns at once with the current chain and starts
+ * a renewal in the background. Only when there is no usable chain, on first use or after expiry,
+ * does [signer] wait for enrollment.
+ *
+ * Concurrent requests for the same alias share a single enrollment.
+ *
+ * ```kotlin
+ * val certificates = CertificateLifecycleManager.forSigningServer(
+ *     storageDir = File(context.filesDir, "certificates"),
+ *     certificateConfig = CertificateManager.CertificateConfig(commonName = "My Camera"),
+ *     signingServerUrl = "https://signing.example.com",
+ * )
+ * certificates.prefetch("capture-key") // at launch
+ * certificates.signer("capture-key").use { signer -> builder.sign(...) }
+ * ```
+ *
+ * @param storageDir Directory where issued chains are kept
+ * @param enroll Obtains a new certificate chain in PEM format for a key alias
+ * @param signerFactory Builds a signer for a key alias from a certificate chain
+ * @param renewalFraction Fraction of a certificate's validity period, counted back from expiry,
+ * during which it is renewed in the background
+ * @param retryIntervalMillis Minimum time between background renewal attempts for one alias
+ * @param clock Source of the current time in milliseconds
+ */
+class CertificateLifecycleManager @JvmOverloads constructor(
+    private val storageDir: File,
+    private val enroll: suspend (keyAlias: String) -> String,
+    private val signerFactory: (keyAlias: String, certificateChainPEM: String) -> Signer,
+    private val renewalFraction: Double = 0.2,
+    private val retryIntervalMillis: Long = 60_000,
+    private val clock: () -> Long = System::currentTimeMillis,
+) : Closeable {
+
+    /**
+     * A stored certificate chain.
+     *
+     * @property certificateChainPEM The chain in PEM format, leaf first
+     * @property notBefore Start of the leaf certificate's validity, in epoch milliseconds
+     * @property notAfter End of the leaf certificate's validity, in epoch milliseconds
+     */
+    data class CachedCertificate(
+        val certificateChainPEM: String,
+        val notBefore: Long,
+        val notAfter: Long,
+    ) {
+        /** When background renewal starts for this certificate, in epoch milliseconds. */
+        fun renewalTime(renewalFraction: Double): Long =
+            notAfter - ((notAfter - notBefore) * renewalFraction).toLong()
+    }
+
+    private val scope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
+    private val cache = ConcurrentHashMap<String, CachedCertificate>()
+    private val enrollments = ConcurrentHashMap<String, Deferred<CachedCertificate>>()
+    private val lastRenewalAttempt = ConcurrentHashMap<String, Long>()
+
+    @Volatile
+    private var lastError: Throwable? = null
+
+    init {
+        require(renewalFraction in 0.0..1.0) { "renewalFraction must be between 0 and 1" }
+    }
+
+    companion object {
+        /**
+         * Creates a manager that enrolls hardware-backed keys with a signing server using
+         * [CertificateManager.enrollCertificate] and signs with [KeyStoreSigner].
+         *
+         * @param storageDir Directory where issued chains are kept
+         * @param certificateConfig Subject for issued certificates
+         * @param signingServerUrl URL of the signing server
+         * @param apiKey Optional API key for authentication
+         * @param requireStrongBox Whether to require StrongBox for newly created keys
+         * @param tsaURL Optional timestamp authority URL for the signers
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun forSigningServer(
+            storageDir: File,
+            certificateConfig: CertificateManager.CertificateConfig,
+            signingServerUrl: String = CertificateManager.LOCAL_SERVER,
+            apiKey: String? = null,
+            requireStrongBox: Boolean = false,
+            tsaURL: String? = null,
+        ): CertificateLifecycleManager = CertificateLifecycleManager(
+            storageDir = storageDir,
+            enroll = { keyAlias ->
+                CertificateManager.enrollCertificate(
+                    keyAlias,
+                    certificateConfig,
+                    signingServerUrl,
+                    apiKey,
+                    requireStrongBox,
+                )
+            },
+            signerFactory = { keyAlias, chain ->
+                KeyStoreSigner.createSigner(SigningAlgorithm.ES256, chain, keyAlias, tsaURL)
+            },
+        )
+    }
+
+    /**
+     * Returns a signer for [keyAlias].
+     *
+     * Returns immediately when a valid chain is stored, starting a background renewal if the
+     * certificate is close to expiry. Otherwise waits for enrollment.
+     *
+     * @throws C2PAError.Api if there is no valid chain and enrollment fails
+     */
+    @Throws(C2PAError::class)
+    suspend fun signer(keyAlias: String): Signer {
+        val certificate = certificate(keyAlias)
+        return signerFactory(keyAlias, certificate.certificateChainPEM)
+    }
+
+    /**
+     * Returns a valid certificate chain for [keyAlias], enrolling if necessary.
+     *
+     * @throws C2PAError.Api if there is no valid chain and enrollment fails
+     */
+    @Throws(C2PAError::class)
+    suspend fun certificate(keyAlias: String): CachedCertificate {
+        val now = clock()
+        val cached = cached(keyAlias)
+        if (cached != null && now < cached.notAfter) {
+            if (now >= cached.renewalTime(renewalFraction)) {
+                renewInBackground(keyAlias, now)
+            }
+            return cached
+        }
+        return startEnrollment(keyAlias).await()
+    }
+
+    /**
+     * Ensures [keyAlias] has a certificate, enrolling in the background if it has none or it is
+     * due for renewal. Call this at launch so that the first capture does not wait for a CSR
+     * round trip.
+     */
+    fun prefetch(keyAlias: String) {
+        val now = clock()
+        val cached = cached(keyAlias)
+        when {
+            cached == null || now >= cached.notAfter -> startEnrollment(keyAlias)
+            now >= cached.renewalTime(renewalFraction) -> renewInBackground(keyAlias, now)
+        }
+    }
+
+    /**
+     * Enrolls a new certificate for [keyAlias] now, regardless of the stored one.
+     *
+     * @throws C2PAError.Api if enrollment fails
+     */
+    @Throws(C2PAError::class)
+    suspend fun renew(keyAlias: String): CachedCertificate = startEnrollment(keyAlias).await()
+
+    /** Whether an enrollment or renewal for [keyAlias] is in progress. */
+    fun isEnrolling(keyAlias: String): Boolean = enrollments.containsKey(keyAlias)
+
+    /** Returns the stored chain for [keyAlias], valid or not, without enrolling. */
+    fun cached(keyAlias: String): CachedCertificate? =
+        cache[keyAlias] ?: load(keyAlias)?.also { cache[keyAlias] = it }
+
+    /**
+     * Forgets the stored chain for [keyAlias], for example after its key has been deleted or
+     * replaced. The next [signer] call enrolls again.
+     */
+    fun invalidate(keyAlias: String) {
+        cache.remove(keyAlias)
+        lastRenewalAttempt.remove(keyAlias)
+        fileFor(keyAlias).delete()
+    }
+
+    /** The error from the most recent failed enrollment, if any. */
+    val lastEnrollmentError: Throwable?
+        get() = lastError
+
+    /** Cancels background renewals in progress. */
+    override fun close() {
+        scope.cancel()
+    }
+
+    private fun renewInBackground(keyAlias: String, now: Long) {
+        val last = lastRenewalAttempt[keyAlias]
+        if (last != null && now - last < retryIntervalMillis) return
+        lastRenewalAttempt[keyAlias] = now
+        startEnrollment(keyAlias)
+    }
+
+    private fun startEnrollment(keyAlias: String): Deferred<CachedCertificate> {
+        enrollments[keyAlias]?.let { return it }
+        val enrollment = scope.async(start = CoroutineStart.LAZY) {
+            try {
+                val chain = enroll(keyAlias)
+                val certificate = parse(chain)
+                store(keyAlias, certificate)
+                lastError = null
+                certificate
+            } catch (e: C2PAError) {
+                lastError = e
+                throw e
+            } catch (e: Exception) {
+                lastError = e
+                throw C2PAError.Api("Certificate enrollment failed for '$keyAlias': ${e.message}")
+            }
+        }
+        val existing = enrollments.putIfAbsent(keyAlias, enrollment)
+        if (existing != null) {
+            enrollment.cancel()
+            return existing
+        }
+        enrollment.invokeOnCompletion { enrollments.remove(keyAlias, enrollment) }
+        enrollment.start()
+        return enrollment
+    }
+
+    private fun store(keyAlias: String, certificate: CachedCertificate) {
+        cache[keyAlias] = certificate
+        try {
+            storageDir.mkdirs()
+            val file = fileFor(keyAlias)
+            val temp = File(storageDir, "${file.name}.tmp")
+            temp.writeText(certificate.certificateChainPEM)
+            if (!temp.renameTo(file)) {
+                file.delete()
+                temp.renameTo(file)
+            }
+        } catch (e: IOException) {
+            // The chain is still cached in memory; it is enrolled again after a restart
+        }
+    }
+
+    private fun load(keyAlias: String): CachedCertificate? {
+        val file = fileFor(keyAlias)
+        if (!file.exists()) return null
+        return try {
+            parse(file.readText())
+        } catch (e: Exception) {
+            file.delete()
+            null
+        }
+    }
+
+    private fun parse(chainPEM: String): CachedCertificate {
+        val leaf = try {
+            CertificateFactory.getInstance("X.509")
+                .generateCertificate(ByteArrayInputStream(chainPEM.toByteArray())) as X509Certificate
+        } catch (e: CertificateException) {
+            throw C2PAError.Api("Invalid certificate chain: ${e.message}")
+        }
+        return CachedCertificate(chainPEM, leaf.notBefore.time, leaf.notAfter.time)
+    }
+
+    private fun fileFor(keyAlias: String): File =
+        File(storageDir, URLEncoder.encode(keyAlias, "UTF-8") + ".pem")
+}
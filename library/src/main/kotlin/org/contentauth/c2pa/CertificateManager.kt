@@ -321,6 +321,9 @@ object CertificateManager {
      * Creates a hardware-backed signer by generating a CSR, submitting it to the signing server,
      * and configuring the signer with the returned certificate chain.
      *
+     * This enrolls a new certificate on every call. Use [CertificateLifecycleManager] to reuse
+     * issued certificates until they are due for renewal.
+     *
      * @param keyAlias The alias for the hardware key
      * @param certificateConfig Configuration for the certificate
      * @param signingServerUrl URL of the signing server
@@ -337,6 +340,38 @@ object CertificateManager {
         apiKey: String? = null,
         requireStrongBox: Boolean = false,
     ): Signer {
+        val certificateChain =
+            enrollCertificate(keyAlias, certificateConfig, signingServerUrl, apiKey, requireStrongBox)
+
+        // Create signer with the certificate chain using KeyStoreSigner
+        return KeyStoreSigner.createSigner(
+            algorithm = SigningAlgorithm.ES256,
+            certificateChainPEM = certificateChain,
+            keyAlias = keyAlias,
+            tsaURL = null,
+        )
+    }
+
+    /**
+     * Obtains a certificate for a hardware-backed key by generating a CSR and submitting it to the
+     * signing server. The key is created first if it does not exist.
+     *
+     * @param keyAlias The alias for the hardware key
+     * @param certificateConfig Configuration for the certificate
+     * @param signingServerUrl URL of the signing server
+     * @param apiKey Optional API key for authentication
+     * @param requireStrongBox Whether to require StrongBox when creating the key
+     * @return The issued certificate chain in PEM format
+     * @throws C2PAError.Api if the signing server rejects the CSR or cannot be reached
+     */
+    @JvmStatic
+    suspend fun enrollCertificate(
+        keyAlias: String,
+        certificateConfig: CertificateConfig,
+        signingServerUrl: String = LOCAL_SERVER,
+        apiKey: String? = null,
+        requireStrongBox: Boolean = false,
+    ): String {
         // Generate hardware-backed key if it doesn't exist
         if (!KeyStoreSigner.keyExists(keyAlias)) {
             generateHardwareKey(keyAlias, requireStrongBox)
@@ -349,15 +384,7 @@ object CertificateManager {
         val metadata =
             CSRMetadata(deviceId = Build.ID, appVersion = "1.0.0", purpose = "c2pa-signing")
 
-        val response = submitCSR(csr, metadata, signingServerUrl, apiKey).getOrThrow()
-
-        // Create signer with the certificate chain using KeyStoreSigner
-        return KeyStoreSigner.createSigner(
-            algorithm = SigningAlgorithm.ES256,
-            certificateChainPEM = response.certificate_chain,
-            keyAlias = keyAlias,
-            tsaURL = null,
-        )
+        return submitCSR(csr, metadata, signingServerUrl, apiKey).getOrThrow().certificate_chain
     }
 
     /**
@@ -467,5 +494,5 @@ object CertificateManager {
         }
     }
 
-    private const val LOCAL_SERVER = "http://localhost:8080"
+    internal const val LOCAL_SERVER = "http://localhost:8080"
 }
@@ -0,0 +1,471 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import org.bouncycastle.jce.provider.BouncyCastleProvider
+import org.contentauth.c2pa.CoseSignatureLayout.CborSpanReader
+import java.io.ByteArrayInputStream
+import java.io.ByteArrayOutputStream
+import java.nio.ByteBuffer
+import java.security.GeneralSecurityException
+import java.security.Signature
+import java.security.cert.CertificateFactory
+import java.security.cert.X509Certificate
+
+/**
+ * Checks claim signatures in a manifest store without hashing the asset.
+ *
+ * The native library validates signatures only together with the asset's hard bindings, so for
+ * [VerificationLevel.SIGNATURE_ONLY] the manifest store is located in the asset here, and the
+ * COSE_Sign1 signature over the claim is verified with the leaf certificate from its `x5chain`.
+ * The chain is not validated and no trust list is consulted, so a passing check shows only that
+ * the claim is intact, not who signed it.
+ * JPEG and PNG are supported; [extractManifestStore] returns null for other formats. Ingredient
+ * manifests in the store are independent of each other and can be checked concurrently.
+ */
+internal object ClaimSignatureVerifier {
+
+    private val provider = BouncyCastleProvider()
+
+    private val CLAIM_LABELS = listOf("c2pa.claim.v2", "c2pa.claim")
+
+    // COSE header labels
+    private const val ALG = 1L
+    private const val X5CHAIN = 33L
+
+    /** COSE algorithm identifiers mapped to names and JCA signature algorithms that take raw COSE signatures. */
+    private val ALGORITHMS = mapOf(
+        -7L to ("ES256" to "SHA256withPLAIN-ECDSA"),
+        -35L to ("ES384" to "SHA384withPLAIN-ECDSA"),
+        -36L to ("ES512" to "SHA512withPLAIN-ECDSA"),
+        -37L to ("PS256" to "SHA256withRSAandMGF1"),
+        -38L to ("PS384" to "SHA384withRSAandMGF1"),
+        -39L to ("PS512" to "SHA512withRSAandMGF1"),
+        -8L to ("Ed25519" to "Ed25519"),
+    )
+
+    /**
+     * Reads the embedded JUMBF manifest store from [stream], touching only the container
+     * structure, or returns null if the format is unsupported or has no manifest. Leaves the
+     * stream at its start.
+     */
+    fun extractManifestStore(format: String, stream: Stream): ByteArray? {
+        stream.seek(0, SeekMode.START.value)
+        return try {
+            when (format.lowercase().substringAfterLast('/')) {
+                "jpeg", "jpg" -> extractFromJpeg(stream)
+                "png" -> extractFromPng(stream)
+                else -> null
+            }
+        } catch (e: IllegalArgumentException) {
+            null
+        } finally {
+            stream.seek(0, SeekMode.START.value)
+        }
+    }
+
+    /**
+     * Returns the byte range the embedded manifest store occupies in [stream], including its
+     * container framing (the APP11 segments of a JPEG or the `caBX` chunk of a PNG), or null if
+     * the format is unsupported, there is no manifest, or the store is not stored contiguously.
+     * Leaves the stream at its start.
+     */
+    fun locateManifestStore(format: String, stream: Stream): LongRange? {
+        stream.seek(0, SeekMode.START.value)
+        return try {
+            when (format.lowercase().substringAfterLast('/')) {
+                "jpeg", "jpg" -> locateInJpeg(stream)
+                "png" -> locateInPng(stream)
+                else -> null
+            }
+        } catch (e: IllegalArgumentException) {
+            null
+        } finally {
+            stream.seek(0, SeekMode.START.value)
+        }
+    }
+
+    /** Verifies the claim signature of the active manifest in a JUMBF manifest store. */
+    fun verify(store: ByteArray, cache: SignatureVerificationCache.Scope? = null): ClaimIntegrityCheck =
+        verifyManifest(store, cache)
+
+    /**
+     * Returns the byte range of each manifest box in a manifest store, keyed by manifest label,
+     * in store order. The active manifest is last.
+     */
+    fun manifests(store: ByteArray): Map<String, IntRange> = manifests(ByteBuffer.wrap(store))
+
+    /**
+     * Like [manifests] for the remaining bytes of [buffer], reading only box headers and labels
+     * in place, so a direct or mapped store is never copied onto the heap.
+     */
+    fun manifests(buffer: ByteBuffer): Map<String, IntRange> {
+        val store = buffer.slice()
+        val result = LinkedHashMap<String, IntRange>()
+        try {
+            val top = boxAt(store, 0, store.limit())
+            if (top.type != "jumb") return result
+            var offset = firstChild(store, top) ?: return result
+            while (offset < top.end) {
+                val child = boxAt(store, offset, top.end)
+                if (child.type == "jumb") {
+                    superboxLabel(store, child)?.let { result[it] = child.start until child.end }
+                }
+                offset = child.end
+            }
+        } catch (e: IllegalArgumentException) {
+            // Return the manifests found before the malformed box
+        }
+        return result
+    }
+
+    /**
+     * Verifies the claim signature in [manifest], which is a single manifest box or a store whose
+     * last manifest is checked. Results are memoized in [cache] when one is given.
+     */
+    fun verifyManifest(manifest: ByteArray, cache: SignatureVerificationCache.Scope? = null): ClaimIntegrityCheck =
+        try {
+            val claim = claim(manifest)
+            val cose = CoseSignatureLayout.lastCborBox(manifest, "c2pa.signature")
+            when {
+                claim == null -> ClaimIntegrityCheck(false, message = "No claim found in manifest")
+                cose == null -> ClaimIntegrityCheck(false, message = "No claim signature found in manifest")
+                else -> verifyCoseSign1(manifest, cose, manifest.copyOfRange(claim.first, claim.last + 1), cache)
+            }
+        } catch (e: IllegalArgumentException) {
+            ClaimIntegrityCheck(false, message = "Malformed claim signature: ${e.message}")
+        } catch (e: IndexOutOfBoundsException) {
+            ClaimIntegrityCheck(false, message = "Malformed claim signature")
+        }
+
+    /** Returns the range of the CBOR claim of the last manifest in [manifest], or null if there is none. */
+    fun claim(manifest: ByteArray): IntRange? =
+        CLAIM_LABELS.mapNotNull { CoseSignatureLayout.lastCborBox(manifest, it) }.maxByOrNull { it.first }
+
+    /**
+     * Returns the signing certificate chain, leaf first, from the claim signature of the last
+     * manifest in [manifest], or an empty list if it cannot be read.
+     */
+    fun signingChain(manifest: ByteArray): List<X509Certificate> =
+        try {
+            val cose = CoseSignatureLayout.lastCborBox(manifest, "c2pa.signature") ?: return emptyList()
+            val headers = readCoseSign1(manifest, cose).headers
+            val factory = CertificateFactory.getInstance("X.509")
+            headers.certificates.map { factory.generateCertificate(ByteArrayInputStream(it)) as X509Certificate }
+        } catch (e: IllegalArgumentException) {
+            emptyList()
+        } catch (e: IndexOutOfBoundsException) {
+            emptyList()
+        } catch (e: GeneralSecurityException) {
+            emptyList()
+        }
+
+    private class Box(val type: String, val start: Int, val contentStart: Int, val end: Int)
+
+    private fun boxAt(bytes: ByteBuffer, offset: Int, limit: Int): Box {
+        require(offset + 8 <= limit) { "truncated JUMBF box" }
+        val length = bytes.getInt(offset).toLong() and 0xFFFFFFFFL
+        val type = String(ByteArray(4) { bytes.get(offset + 4 + it) }, Charsets.US_ASCII)
+        val (headerSize, boxLength) = when (length) {
+            0L -> 8 to (limit - offset).toLong()
+            1L -> {
+                require(offset + 16 <= limit) { "truncated JUMBF box" }
+                16 to bytes.getLong(offset + 8)
+            }
+            else -> 8 to length
+        }
+        require(boxLength >= headerSize && offset + boxLength <= limit) { "invalid JUMBF box length" }
+        return Box(type, offset, offset + headerSize, offset + boxLength.toInt())
+    }
+
+    /** Returns the offset of the first child after a superbox's description box. */
+    private fun firstChild(bytes: ByteBuffer, superbox: Box): Int? {
+        if (superbox.contentStart >= superbox.end) return null
+        val description = boxAt(bytes, superbox.contentStart, superbox.end)
+        return if (description.type == "jumd") description.end else null
+    }
+
+    /** Returns the label from a superbox's description box, if it has one. */
+    private fun superboxLabel(bytes: ByteBuffer, superbox: Box): String? {
+        val description = boxAt(bytes, superbox.contentStart, superbox.end)
+        if (description.type != "jumd") return null
+        // Content type UUID, then toggles; bit 1 of the toggles marks a label
+        val toggles = description.contentStart + 16
+        if (toggles >= description.end || bytes.get(toggles).toInt() and 0x02 == 0) return null
+        var end = toggles + 1
+        while (end < description.end && bytes.get(end) != 0.toByte()) end++
+        return String(ByteArray(end - toggles - 1) { bytes.get(toggles + 1 + it) }, Charsets.UTF_8)
+    }
+
+    private fun verifyCoseSign1(
+        store: ByteArray,
+        cose: IntRange,
+        payload: ByteArray,
+        cache: SignatureVerificationCache.Scope?,
+    ): ClaimIntegrityCheck {
+        val sign1 = readCoseSign1(store, cose)
+        val headers = sign1.headers
+        val (name, jcaAlgorithm) = headers.algorithm?.let { ALGORITHMS[it] }
+            ?: return ClaimIntegrityCheck(false, message = "Unsupported COSE algorithm ${headers.algorithm}")
+        val leafDer = headers.leafCertificate
+            ?: return ClaimIntegrityCheck(false, name, message = "No signing certificate in x5chain")
+
+        val toBeSigned = sigStructure(sign1.protectedHeader, payload)
+        val verify = { verifySignature(name, jcaAlgorithm, leafDer, toBeSigned, sign1.signature) }
+        return cache?.cache?.getOrVerify(cache.trust, toBeSigned, sign1.signature, leafDer, verify) ?: verify()
+    }
+
+    private fun verifySignature(
+        name: String,
+        jcaAlgorithm: String,
+        leafDer: ByteArray,
+        toBeSigned: ByteArray,
+        signature: ByteArray,
+    ): ClaimIntegrityCheck =
+        try {
+            val leaf = CertificateFactory.getInstance("X.509")
+                .generateCertificate(ByteArrayInputStream(leafDer)) as X509Certificate
+            val intact = Signature.getInstance(jcaAlgorithm, provider).run {
+                initVerify(leaf.publicKey)
+                update(toBeSigned)
+                verify(signature)
+            }
+            ClaimIntegrityCheck(
+                intact,
+                name,
+                leaf.subjectX500Principal.name,
+                if (intact) null else "Claim signature does not match the signing certificate",
+            )
+        } catch (e: GeneralSecurityException) {
+            ClaimIntegrityCheck(false, name, message = "Signature check failed: ${e.message}")
+        }
+    }
+
+    private class CoseSign1(val protectedHeader: ByteArray, val headers: HeaderValues, val signature: ByteArray)
+
+    private fun readCoseSign1(store: ByteArray, cose: IntRange): CoseSign1 {
+        val reader = CborSpanReader(store, cose.first, cose.last + 1)
+        var head = reader.readHead()
+        if (head.major == CborSpanReader.TAG) head = reader.readHead()
+        require(head.major == CborSpanReader.ARRAY && head.value == 4L) { "not a COSE_Sign1" }
+
+        val protectedHeader = reader.readBytes()
+        val headers = HeaderValues()
+        if (protectedHeader.isNotEmpty()) {
+            readHeaderMap(CborSpanReader(protectedHeader, 0, protectedHeader.size), headers)
+        }
+        readHeaderMap(reader, headers)
+        reader.skip() // Detached payload
+        return CoseSign1(protectedHeader, headers, reader.readBytes())
+    }
+
+    private class HeaderValues {
+        var algorithm: Long? = null
+        val certificates = mutableListOf<ByteArray>()
+        val leafCertificate: ByteArray? get() = certificates.firstOrNull()
+    }
+
+    private fun readHeaderMap(reader: CborSpanReader, headers: HeaderValues) {
+        val map = reader.readHead()
+        require(map.major == CborSpanReader.MAP) { "expected a header map" }
+        repeat(map.value.toInt()) {
+            val keyStart = reader.position
+            val keyHead = reader.readHead()
+            val key = when (keyHead.major) {
+                CborSpanReader.UNSIGNED -> keyHead.value
+                CborSpanReader.NEGATIVE -> -1 - keyHead.value
+                else -> {
+                    reader.position = keyStart
+                    reader.skip()
+                    null
+                }
+            }
+            when (key) {
+                ALG -> {
+                    val valueStart = reader.position
+                    val value = reader.readHead()
+                    when (value.major) {
+                        CborSpanReader.NEGATIVE -> headers.algorithm = -1 - value.value
+                        CborSpanReader.UNSIGNED -> headers.algorithm = value.value
+                        else -> {
+                            // Text algorithm names are not used by C2PA
+                            reader.position = valueStart
+                            reader.skip()
+                        }
+                    }
+                }
+                X5CHAIN -> {
+                    val valueStart = reader.position
+                    val value = reader.readHead()
+                    if (value.major == CborSpanReader.ARRAY) {
+                        repeat(value.value.toInt()) { headers.certificates += reader.readBytes() }
+                    } else {
+                        reader.position = valueStart
+                        headers.certificates += reader.readBytes()
+                    }
+                }
+                else -> reader.skip()
+            }
+        }
+    }
+
+    /** Encodes the COSE `Sig_structure` for a COSE_Sign1 with empty external AAD. */
+    private fun sigStructure(protectedHeader: ByteArray, payload: ByteArray): ByteArray =
+        ByteArrayOutputStream(payload.size + protectedHeader.size + 32).apply {
+            write(0x84) // array(4)
+            val context = "Signature1".toByteArray()
+            writeHead(3, context.size.toLong())
+            write(context)
+            writeHead(2, protectedHeader.size.toLong())
+            write(protectedHeader)
+            writeHead(2, 0) // external_aad
+            writeHead(2, payload.size.toLong())
+            write(payload)
+        }.toByteArray()
+
+    private fun ByteArrayOutputStream.writeHead(major: Int, value: Long) {
+        val type = major shl 5
+        when {
+            value < 24 -> write(type or value.toInt())
+            value < 0x100 -> {
+                write(type or 24)
+                write(value.toInt())
+            }
+            value < 0x10000 -> {
+                write(type or 25)
+                repeat(2) { write((value shr (8 * (1 - it))).toInt() and 0xFF) }
+            }
+            else -> {
+                write(type or 26)
+                repeat(4) { write((value shr (8 * (3 - it))).toInt() and 0xFF) }
+            }
+        }
+    }
+
+    /**
+     * Reassembles C2PA JUMBF from JPEG APP11 segments. Each segment carries the box instance
+     * number and a sequence number; continuation segments repeat the 8-byte box header.
+     */
+    private fun extractFromJpeg(stream: Stream): ByteArray? {
+        val soi = readFully(stream, 2)
+        require(soi[0] == 0xFF.toByte() && soi[1] == 0xD8.toByte()) { "not a JPEG" }
+        val boxes = LinkedHashMap<Int, ByteArrayOutputStream>()
+        while (true) {
+            val marker = readFully(stream, 2)
+            require(marker[0] == 0xFF.toByte()) { "invalid JPEG marker" }
+            val type = marker[1].toInt() and 0xFF
+            when {
+                type == 0xD9 || type == 0xDA -> break // EOI or start of scan: no metadata follows
+                type == 0x01 || type in 0xD0..0xD7 -> continue
+            }
+            val length = readFully(stream, 2).let { ((it[0].toInt() and 0xFF) shl 8) or (it[1].toInt() and 0xFF) }
+            require(length >= 2) { "invalid JPEG segment length" }
+            if (type != 0xEB) {
+                stream.seek((length - 2).toLong(), SeekMode.CURRENT.value)
+                continue
+            }
+            val segment = readFully(stream, length - 2)
+            // "JP" common identifier, 2-byte box instance, 4-byte sequence number, then box data
+            if (segment.size < 8 || segment[0] != 'J'.code.toByte() || segment[1] != 'P'.code.toByte()) continue
+            val instance = ((segment[2].toInt() and 0xFF) shl 8) or (segment[3].toInt() and 0xFF)
+            val box = boxes[instance]
+            if (box == null) {
+                boxes[instance] = ByteArrayOutputStream().apply { write(segment, 8, segment.size - 8) }
+            } else if (segment.size > 16) {
+                box.write(segment, 16, segment.size - 16)
+            }
+        }
+        return boxes.values.map { it.toByteArray() }.firstOrNull { isManifestStore(it) }
+    }
+
+    /** Returns the content of the `caBX` chunk, skipping other chunks without reading them. */
+    private fun extractFromPng(stream: Stream): ByteArray? {
+        val signature = readFully(stream, 8)
+        require(signature[1] == 'P'.code.toByte() && signature[2] == 'N'.code.toByte()) { "not a PNG" }
+        while (true) {
+            val header = readFully(stream, 8)
+            val length = ((header[0].toLong() and 0xFF) shl 24) or ((header[1].toLong() and 0xFF) shl 16) or
+                ((header[2].toLong() and 0xFF) shl 8) or (header[3].toLong() and 0xFF)
+            when (String(header, 4, 4, Charsets.US_ASCII)) {
+                "caBX" -> {
+                    require(length <= Int.MAX_VALUE) { "caBX chunk too large" }
+                    return readFully(stream, length.toInt()).takeIf { isManifestStore(it) }
+                }
+                "IEND" -> return null
+                else -> stream.seek(length + 4, SeekMode.CURRENT.value) // data and CRC
+            }
+        }
+    }
+
+    private fun locateInJpeg(stream: Stream): LongRange? {
+        val soi = readFully(stream, 2)
+        require(soi[0] == 0xFF.toByte() && soi[1] == 0xD8.toByte()) { "not a JPEG" }
+        var offset = 2L
+        var start = -1L
+        var end = -1L
+        while (true) {
+            val marker = readFully(stream, 2)
+            require(marker[0] == 0xFF.toByte()) { "invalid JPEG marker" }
+            val type = marker[1].toInt() and 0xFF
+            if (type == 0xD9 || type == 0xDA) break
+            if (type == 0x01 || type in 0xD0..0xD7) {
+                offset += 2
+                continue
+            }
+            val length = readFully(stream, 2).let { ((it[0].toInt() and 0xFF) shl 8) or (it[1].toInt() and 0xFF) }
+            require(length >= 2) { "invalid JPEG segment length" }
+            val isC2pa = type == 0xEB && length >= 4 &&
+                readFully(stream, 2).let { it[0] == 'J'.code.toByte() && it[1] == 'P'.code.toByte() }
+            stream.seek(offset + 2 + length, SeekMode.START.value)
+            if (isC2pa) {
+                if (start < 0) start = offset else if (end != offset) return null
+                end = offset + 2 + length
+            }
+            offset += 2 + length
+        }
+        return if (start < 0) null else start until end
+    }
+
+    private fun locateInPng(stream: Stream): LongRange? {
+        readFully(stream, 8)
+        var offset = 8L
+        while (true) {
+            val header = readFully(stream, 8)
+            val length = ((header[0].toLong() and 0xFF) shl 24) or ((header[1].toLong() and 0xFF) shl 16) or
+                ((header[2].toLong() and 0xFF) shl 8) or (header[3].toLong() and 0xFF)
+            when (String(header, 4, 4, Charsets.US_ASCII)) {
+                "caBX" -> return offset until offset + 12 + length
+                "IEND" -> return null
+            }
+            stream.seek(length + 4, SeekMode.CURRENT.value)
+            offset += 12 + length
+        }
+    }
+
+    private fun isManifestStore(box: ByteArray): Boolean =
+        box.size > 8 && String(box, 4, 4, Charsets.US_ASCII) == "jumb" &&
+            CoseSignatureLayout.lastCborBox(box, "c2pa.signature") != null
+
+    private fun readFully(stream: Stream, count: Int): ByteArray {
+        val buffer = ByteArray(count)
+        var read = 0
+        val chunk = ByteArray(minOf(count, 64 * 1024).coerceAtLeast(1))
+        while (read < count) {
+            val n = stream.read(chunk, minOf(chunk.size, count - read).toLong()).toInt()
+            require(n > 0) { "unexpected end of stream" }
+            System.arraycopy(chunk, 0, buffer, read, n)
+            read += n
+        }
+        return buffer
+    }
+}
@@ -0,0 +1,38 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import java.io.File
+import java.io.InputStream
+
+/**
+ * A file in a multi-file asset, such as one half of a RAW+JPEG pair, for
+ * [Builder.signCollection].
+ *
+ * @property uri The member's path relative to the manifest, as recorded in the assertion
+ * @property format The member's MIME type, if known
+ * @property open Opens the member's content
+ */
+class CollectionMember @JvmOverloads constructor(
+    val uri: String,
+    val format: String? = null,
+    val open: () -> InputStream,
+) {
+    companion object {
+        /** A member read from [file], recorded under [uri]. */
+        @JvmStatic
+        @JvmOverloads
+        fun fromFile(file: File, uri: String = file.name, format: String? = null): CollectionMember =
+            CollectionMember(uri, format) { file.inputStream() }
+    }
+}
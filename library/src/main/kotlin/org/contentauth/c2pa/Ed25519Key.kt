@@ -0,0 +1,141 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import org.bouncycastle.crypto.params.Ed25519PrivateKeyParameters
+import org.bouncycastle.crypto.params.Ed25519PublicKeyParameters
+import org.bouncycastle.crypto.signers.Ed25519Signer
+import org.bouncycastle.crypto.util.PrivateKeyFactory
+import org.bouncycastle.util.io.pem.PemReader
+import java.io.IOException
+import java.io.StringReader
+
+/**
+ * An Ed25519 private key parsed once for repeated signing.
+ *
+ * [C2PA.ed25519Sign] parses the PEM key on every call. For workflows that sign many small
+ * payloads with the same key, such as CAWG identity assertions, load the key once and sign in
+ * batches. Signatures are identical to those produced by [C2PA.ed25519Sign], since Ed25519 is
+ * deterministic.
+ *
+ * Instances are immutable and safe to share between threads.
+ *
+ * ```kotlin
+ * val key = Ed25519Key.load(privateKeyPem)
+ * val signatures = key.signBatch(payloads)
+ * val valid = Ed25519Key.verifyBatch(payloads, signatures, key.publicKey)
+ * ```
+ */
+class Ed25519Key private constructor(private val privateKey: Ed25519PrivateKeyParameters) {
+
+    private val publicKeyParameters: Ed25519PublicKeyParameters = privateKey.generatePublicKey()
+
+    /** The raw 32-byte public key. */
+    val publicKey: ByteArray
+        get() = publicKeyParameters.encoded
+
+    companion object {
+        /** Length in bytes of an Ed25519 signature. */
+        const val SIGNATURE_LENGTH = 64
+
+        /** Length in bytes of a raw Ed25519 public key. */
+        const val PUBLIC_KEY_LENGTH = 32
+
+        /**
+         * Parses a PEM-encoded PKCS#8 Ed25519 private key.
+         *
+         * @param pem The private key in PEM format
+         * @return The parsed key
+         * @throws C2PAError.Api if the PEM cannot be parsed or does not hold an Ed25519 key
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        fun load(pem: String): Ed25519Key {
+            val parameters = try {
+                val pemObject = PemReader(StringReader(pem)).use { it.readPemObject() }
+                    ?: throw C2PAError.Api("No PEM object found in private key")
+                PrivateKeyFactory.createKey(pemObject.content)
+            } catch (e: IOException) {
+                throw C2PAError.Api("Failed to parse Ed25519 private key: ${e.message}")
+            } catch (e: IllegalArgumentException) {
+                throw C2PAError.Api("Failed to parse Ed25519 private key: ${e.message}")
+            }
+            val key = parameters as? Ed25519PrivateKeyParameters
+                ?: throw C2PAError.Api("Private key is not an Ed25519 key")
+            return Ed25519Key(key)
+        }
+
+        /**
+         * Verifies a batch of signatures against one public key.
+         *
+         * The public key is decoded once for the whole batch.
+         *
+         * @param messages The signed messages
+         * @param signatures The signatures, in the same order as [messages]
+         * @param publicKey The raw 32-byte Ed25519 public key
+         * @return For each message, whether its signature is valid
+         * @throws IllegalArgumentException if the list sizes differ or the public key length is wrong
+         */
+        @JvmStatic
+        fun verifyBatch(messages: List<ByteArray>, signatures: List<ByteArray>, publicKey: ByteArray): BooleanArray {
+            require(messages.size == signatures.size) {
+                "Expected ${messages.size} signatures, got ${signatures.size}"
+            }
+            require(publicKey.size == PUBLIC_KEY_LENGTH) {
+                "Ed25519 public key must be $PUBLIC_KEY_LENGTH bytes"
+            }
+            val verifier = Ed25519Signer()
+            verifier.init(false, Ed25519PublicKeyParameters(publicKey, 0))
+            return BooleanArray(messages.size) { i ->
+                val signature = signatures[i]
+                if (signature.size != SIGNATURE_LENGTH) {
+                    false
+                } else {
+                    verifier.update(messages[i], 0, messages[i].size)
+                    verifier.verifySignature(signature)
+                }
+            }
+        }
+    }
+
+    /**
+     * Signs a single message.
+     *
+     * @param message The bytes to sign
+     * @return The 64-byte signature
+     */
+    fun sign(message: ByteArray): ByteArray = signBatch(listOf(message))[0]
+
+    /**
+     * Signs a batch of messages.
+     *
+     * @param messages The messages to sign
+     * @return The 64-byte signatures, in the same order as [messages]
+     */
+    fun signBatch(messages: List<ByteArray>): List<ByteArray> {
+        val signer = Ed25519Signer()
+        signer.init(true, privateKey)
+        return messages.map { message ->
+            signer.update(message, 0, message.size)
+            signer.generateSignature()
+        }
+    }
+
+    /**
+     * Verifies signatures produced by this key.
+     *
+     * @see verifyBatch
+     */
+    fun verifyBatch(messages: List<ByteArray>, signatures: List<ByteArray>): BooleanArray =
+        Companion.verifyBatch(messages, signatures, publicKey)
+}
@@ -49,46 +49,74 @@ internal inline fun <T : Any> executeC2PAOperation(errorMessage: String, operati
  * @return Raw signature as concatenated r and s components
  */
 fun derToRawSignature(derSignature: ByteArray, componentLength: Int): ByteArray {
-    var offset = 0
-
-    // Skip SEQUENCE tag (0x30)
-    if (derSignature[offset++].toInt() != 0x30) {
-        throw IllegalArgumentException("Invalid DER signature: missing SEQUENCE tag")
-    }
-
-    // Skip sequence length
-    offset++
-
-    // Read r
-    if (derSignature[offset++].toInt() != 0x02) {
-        throw IllegalArgumentException("Invalid DER signature: missing INTEGER tag for r")
-    }
-
-    val rLength = derSignature[offset++].toInt() and 0xFF
-    val r = derSignature.copyOfRange(offset, offset + rLength)
-    offset += rLength
+    val raw = ByteArray(componentLength * 2)
+    derToRawSignature(derSignature, 0, derSignature.size, componentLength, raw, 0)
+    return raw
+}
 
-    // Read s
-    if (derSignature[offset++].toInt() != 0x02) {
-        throw IllegalArgumentException("Invalid DER signature: missing INTEGER tag for s")
+/**
+ * Converts a DER-encoded ECDSA signature to raw format (r || s) in a single pass, writing into a
+ * caller-supplied buffer without intermediate allocations.
+ *
+ * Long-form DER lengths (as produced for P-521 signatures) are supported.
+ *
+ * @param der Buffer holding the DER-encoded signature
+ * @param derOffset Offset of the signature in [der]
+ * @param derLength Length of the signature in [der]
+ * @param componentLength The length of each component (r and s) in bytes
+ * @param out Destination buffer, which must have room for `2 * componentLength` bytes
+ * @param outOffset Offset in [out] at which r is written; s follows immediately
+ * @throws IllegalArgumentException if the signature is malformed or a component is too long
+ */
+fun derToRawSignature(
+    der: ByteArray,
+    derOffset: Int,
+    derLength: Int,
+    componentLength: Int,
+    out: ByteArray,
+    outOffset: Int,
+) {
+    val end = derOffset + derLength
+    require(derLength >= 8 && end <= der.size) { "Invalid DER signature: truncated" }
+    require(out.size - outOffset >= componentLength * 2) { "Output buffer too small" }
+
+    var offset = derOffset
+    require(der[offset++].toInt() == 0x30) { "Invalid DER signature: missing SEQUENCE tag" }
+    offset += derLengthHeaderSize(der, offset)
+
+    for (component in 0..1) {
+        require(offset < end && der[offset++].toInt() == 0x02) {
+            "Invalid DER signature: missing INTEGER tag for ${if (component == 0) "r" else "s"}"
+        }
+        var length = der[offset++].toInt() and 0xFF
+        if (length and 0x80 != 0) {
+            // Long form: the low bits give the number of length bytes that follow
+            val lengthBytes = length and 0x7F
+            length = 0
+            repeat(lengthBytes) { length = (length shl 8) or (der[offset++].toInt() and 0xFF) }
+        }
+        require(offset + length <= end) { "Invalid DER signature: integer exceeds signature" }
+
+        // Strip DER sign padding, then left-pad to the component length
+        var start = offset
+        var valueLength = length
+        while (valueLength > 0 && der[start].toInt() == 0) {
+            start++
+            valueLength--
+        }
+        require(valueLength <= componentLength) { "Invalid DER signature: component too long" }
+
+        val target = outOffset + component * componentLength
+        out.fill(0, target, target + componentLength - valueLength)
+        System.arraycopy(der, start, out, target + componentLength - valueLength, valueLength)
+        offset += length
     }
+}
 
-    val sLength = derSignature[offset++].toInt() and 0xFF
-    val s = derSignature.copyOfRange(offset, offset + sLength)
-
-    // Remove leading zeros from r and s if present (DER padding)
-    val rStripped = r.dropWhile { it == 0.toByte() }.toByteArray()
-    val sStripped = s.dropWhile { it == 0.toByte() }.toByteArray()
-
-    // Pad to required length
-    val rPadded = ByteArray(componentLength)
-    val sPadded = ByteArray(componentLength)
-
-    System.arraycopy(rStripped, 0, rPadded, componentLength - rStripped.size, rStripped.size)
-    System.arraycopy(sStripped, 0, sPadded, componentLength - sStripped.size, sStripped.size)
-
-    // Return r || s
-    return rPadded + sPadded
+/** Returns the number of bytes used by the DER length starting at [offset]. */
+private fun derLengthHeaderSize(der: ByteArray, offset: Int): Int {
+    val first = der[offset].toInt() and 0xFF
+    return if (first < 0x80) 1 else 1 + (first and 0x7F)
 }
 
 /** The version string of the native C2PA library, lazily fetched once on first access. */
@@ -0,0 +1,290 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import okhttp3.OkHttpClient
+import okhttp3.Request
+import java.io.ByteArrayOutputStream
+import java.io.IOException
+import java.util.concurrent.TimeUnit
+
+/**
+ * Read-only stream over a remote asset, fetched with HTTP `Range` requests.
+ *
+ * The asset is divided into blocks of [blockSize] bytes and only the blocks that are read are
+ * downloaded, so inspecting a manifest fetches the boxes the parser visits rather than the whole
+ * file. Missing blocks needed by one read are fetched together in a single request. When reads
+ * are sequential, up to [readAheadBlocks] further blocks are fetched with them, so a full
+ * verification pass streams the asset in large requests without staging it locally. Up to
+ * [maxCachedBlocks] blocks are kept, least recently used first out.
+ *
+ * If the server ignores `Range` and answers with the whole body, that body is kept and served
+ * from memory.
+ *
+ * ```kotlin
+ * HttpRangeStream("https://cdn.example.com/photo.jpg").use { stream ->
+ *     Reader.fromStream("image/jpeg", stream).use { reader -> reader.json() }
+ * }
+ * ```
+ *
+ * @param url The asset URL
+ * @param headers Additional request headers, for example authorization
+ * @param blockSize Size of a cached block in bytes
+ * @param maxCachedBlocks Maximum number of blocks kept in memory
+ * @param readAheadBlocks Maximum number of blocks fetched beyond a sequential read
+ * @param client The HTTP client to use
+ */
+class HttpRangeStream @JvmOverloads constructor(
+    private val url: String,
+    private val headers: Map<String, String> = emptyMap(),
+    val blockSize: Int = 64 * 1024,
+    private val maxCachedBlocks: Int = 64,
+    private val readAheadBlocks: Int = 8,
+    private val client: OkHttpClient = defaultClient,
+) : Stream() {
+
+    /**
+     * Network and cache activity.
+     *
+     * @property requests HTTP requests made
+     * @property bytesFetched Response bytes received
+     * @property blockHits Block lookups served from the cache
+     * @property blockMisses Block lookups that required a request
+     * @property contentLength Size of the remote asset, or -1 before the first request
+     */
+    data class Stats(
+        val requests: Int,
+        val bytesFetched: Long,
+        val blockHits: Long,
+        val blockMisses: Long,
+        val contentLength: Long,
+    )
+
+    private val blocks = object : LinkedHashMap<Long, ByteArray>(16, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Long, ByteArray>): Boolean =
+            size > maxCachedBlocks
+    }
+
+    private var position = 0L
+    private var length = -1L
+    private var lastReadEnd = -1L
+
+    // Set when the server does not support ranges
+    private var wholeBody: ByteArray? = null
+
+    private var requests = 0
+    private var bytesFetched = 0L
+    private var blockHits = 0L
+    private var blockMisses = 0L
+
+    init {
+        require(blockSize > 0) { "blockSize must be positive" }
+        require(maxCachedBlocks > readAheadBlocks) { "maxCachedBlocks must exceed readAheadBlocks" }
+        require(readAheadBlocks >= 0) { "readAheadBlocks must not be negative" }
+    }
+
+    /** Size of the remote asset in bytes. Fetches the first block if it is not yet known. */
+    @get:Throws(IOException::class)
+    val contentLength: Long
+        get() {
+            if (length < 0) fetch(0, 0)
+            return length
+        }
+
+    override fun read(buffer: ByteArray, length: Long): Long {
+        val requested = length.coerceAtMost(buffer.size.toLong()).coerceAtMost(Int.MAX_VALUE.toLong()).toInt()
+        val total = contentLength
+        if (requested <= 0 || position >= total) return 0L
+        var count = minOf(requested.toLong(), total - position).toInt()
+
+        wholeBody?.let { body ->
+            System.arraycopy(body, position.toInt(), buffer, 0, count)
+            position += count
+            return count.toLong()
+        }
+
+        // Short reads keep one read's blocks, plus read-ahead, within the cache
+        val span = (maxCachedBlocks - readAheadBlocks).toLong() * blockSize - position % blockSize
+        count = minOf(count.toLong(), span).toInt()
+
+        val end = position + count
+        val firstBlock = position / blockSize
+        val lastBlock = (end - 1) / blockSize
+        val sequential = position == lastReadEnd
+        ensureBlocks(firstBlock, lastBlock, if (sequential) readAheadBlocks else 0)
+        // The server may have ignored the range and sent the whole asset instead
+        if (wholeBody != null) return read(buffer, length)
+
+        var copied = 0
+        var block = firstBlock
+        while (copied < count) {
+            val data = blocks[block] ?: throw IOException("Block $block of $url was evicted during a read")
+            val offsetInBlock = ((position + copied) - block * blockSize).toInt()
+            val n = minOf(data.size - offsetInBlock, count - copied)
+            System.arraycopy(data, offsetInBlock, buffer, copied, n)
+            copied += n
+            block++
+        }
+        position = end
+        lastReadEnd = end
+        return count.toLong()
+    }
+
+    override fun seek(offset: Long, mode: Int): Long {
+        val target =
+            when (mode) {
+                SeekMode.START.value -> offset
+                SeekMode.CURRENT.value -> position + offset
+                SeekMode.END.value -> contentLength + offset
+                else -> throw IllegalArgumentException("Invalid seek mode: $mode")
+            }
+        position = target.coerceAtLeast(0)
+        return position
+    }
+
+    override fun write(data: ByteArray, length: Long): Long =
+        throw UnsupportedOperationException("HttpRangeStream is read-only")
+
+    override fun flush(): Long =
+        throw UnsupportedOperationException("HttpRangeStream is read-only")
+
+    /** Returns cumulative request and cache counters. */
+    fun stats(): Stats = Stats(requests, bytesFetched, blockHits, blockMisses, length)
+
+    /**
+     * Makes blocks [first] through [last] resident, fetching each run of adjacent missing blocks
+     * with one request. The final run is extended by up to [readAhead] missing blocks.
+     */
+    private fun ensureBlocks(first: Long, last: Long, readAhead: Int) {
+        val lastBlockInAsset = (length - 1) / blockSize
+        var block = first
+        while (block <= last) {
+            if (blocks.containsKey(block)) {
+                blockHits++
+                blocks[block] // refresh recency
+                block++
+                continue
+            }
+            val runStart = block
+            while (block <= last && !blocks.containsKey(block)) {
+                blockMisses++
+                block++
+            }
+            var runEnd = block - 1
+            if (block > last) {
+                val limit = minOf(lastBlockInAsset, runEnd + readAhead)
+                while (runEnd < limit && !blocks.containsKey(runEnd + 1)) runEnd++
+            }
+            fetch(runStart, runEnd)
+        }
+    }
+
+    /**
+     * Fetches blocks [firstBlock] through [lastBlock], normally with a single range request.
+     * Servers may answer a range request with fewer bytes than asked for; the rest of the range
+     * is then requested until it is complete, so no block is left half-filled.
+     */
+    private fun fetch(firstBlock: Long, lastBlock: Long) {
+        val start = firstBlock * blockSize
+        var end = (lastBlock + 1) * blockSize - 1
+        if (length >= 0) end = minOf(end, length - 1)
+
+        val received = ByteArrayOutputStream()
+        var from = start
+        do {
+            val body = fetchRange(from, end) ?: return
+            if (length >= 0) end = minOf(end, length - 1)
+            if (body.isEmpty() && from <= end) {
+                throw IOException("Server returned no data for bytes $from-$end of $url")
+            }
+            received.write(body)
+            from += body.size
+        } while (from <= end)
+        store(start, received.toByteArray())
+    }
+
+    /**
+     * Requests bytes [from] through [to]. Returns the partial content, or null if the response
+     * was handled otherwise (a whole body from a server without range support, or an empty asset).
+     */
+    private fun fetchRange(from: Long, to: Long): ByteArray? {
+        val requestBuilder = Request.Builder().url(url).get().header("Range", "bytes=$from-$to")
+        headers.forEach { (key, value) -> requestBuilder.header(key, value) }
+
+        requests++
+        client.newCall(requestBuilder.build()).execute().use { response ->
+            val body = response.body?.bytes() ?: throw IOException("Empty response for $url")
+            bytesFetched += body.size
+            when (response.code) {
+                206 -> {
+                    val range = parseContentRange(response.header("Content-Range"))
+                    if (range.first != from) {
+                        throw IOException("Server returned range starting at ${range.first}, expected $from")
+                    }
+                    if (range.third >= 0) length = range.third
+                    if (length < 0) throw IOException("Server did not report the size of $url")
+                    return body
+                }
+                200 -> {
+                    // Range not supported: keep the whole body
+                    wholeBody = body
+                    length = body.size.toLong()
+                    blocks.clear()
+                    return null
+                }
+                416 -> {
+                    length = parseContentRange(response.header("Content-Range")).third.coerceAtLeast(0)
+                    if (length > 0 && from < length) throw IOException("Range $from-$to rejected for $url")
+                    return null
+                }
+                else -> throw IOException("HTTP ${response.code} fetching $url")
+            }
+        }
+    }
+
+    /** Splits a response starting at [start] into blocks. A trailing partial block is kept only at the end of the asset. */
+    private fun store(start: Long, body: ByteArray) {
+        var offset = 0
+        var block = start / blockSize
+        while (offset < body.size) {
+            val n = minOf(blockSize, body.size - offset)
+            val blockEnd = block * blockSize + n
+            if (n < blockSize && blockEnd < length) break
+            blocks[block] = body.copyOfRange(offset, offset + n)
+            offset += n
+            block++
+        }
+    }
+
+    /** Parses `bytes start-end/total`, or `bytes *` + `/total`, into (start, end, total); total is -1 if unknown. */
+    private fun parseContentRange(header: String?): Triple<Long, Long, Long> {
+        val match = header?.let { CONTENT_RANGE.matchEntire(it.trim()) }
+            ?: throw IOException("Missing or invalid Content-Range for $url: $header")
+        val (range, total) = match.destructured
+        val totalLength = if (total == "*") -1L else total.toLong()
+        if (range == "*") return Triple(-1L, -1L, totalLength)
+        val (from, to) = range.split('-').map { it.toLong() }
+        return Triple(from, to, totalLength)
+    }
+
+    private companion object {
+        val CONTENT_RANGE = Regex("bytes\\s+(\\*|\\d+-\\d+)/(\\*|\\d+)", RegexOption.IGNORE_CASE)
+
+        val defaultClient: OkHttpClient by lazy {
+            OkHttpClient.Builder()
+                .connectTimeout(30, TimeUnit.SECONDS)
+                .readTimeout(30, TimeUnit.SECONDS)
+                .build()
+        }
+    }
+}
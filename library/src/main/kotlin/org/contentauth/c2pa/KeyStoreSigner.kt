@@ -22,6 +22,7 @@ import java.security.KeyFactory
 import java.security.KeyStore
 import java.security.PrivateKey
 import java.security.Signature
+import java.util.concurrent.ConcurrentHashMap
 import java.util.concurrent.Executor
 import kotlin.coroutines.resume
 import kotlin.coroutines.resumeWithException
@@ -52,6 +53,12 @@ import kotlin.coroutines.suspendCoroutine
  */
 object KeyStoreSigner {
 
+    private val androidKeyStore: KeyStore by lazy {
+        KeyStore.getInstance("AndroidKeyStore").apply { load(null) }
+    }
+
+    private val pipelines = ConcurrentHashMap<String, KeyStoreSigningPipeline>()
+
     /**
      * Creates a Signer that uses a key from the Android KeyStore.
      *
@@ -67,25 +74,22 @@ object KeyStoreSigner {
         certificateChainPEM: String,
         keyAlias: String,
         tsaURL: String? = null,
-    ): Signer {
-        val signatureAlgorithm =
-            when (algorithm) {
-                SigningAlgorithm.ES256 -> "SHA256withECDSA"
-                SigningAlgorithm.ES384 -> "SHA384withECDSA"
-                SigningAlgorithm.ES512 -> "SHA512withECDSA"
-                SigningAlgorithm.PS256 -> "SHA256withRSA/PSS"
-                SigningAlgorithm.PS384 -> "SHA384withRSA/PSS"
-                SigningAlgorithm.PS512 -> "SHA512withRSA/PSS"
-                SigningAlgorithm.ED25519 ->
-                    throw C2PAError.Api("Ed25519 not supported by Android KeyStore")
-            }
+    ): Signer = pipeline(keyAlias, algorithm).createSigner(certificateChainPEM, tsaURL)
 
-        return Signer.withCallback(
-            algorithm = algorithm,
-            certificateChainPEM = certificateChainPEM,
-            tsaURL = tsaURL,
-        ) { data -> signWithKeyStore(data, keyAlias, signatureAlgorithm, algorithm) }
-    }
+    /**
+     * Returns the shared signing pipeline for a KeyStore key, which caches the key entry and a
+     * per-thread [Signature] across all signers created for [keyAlias] and [algorithm].
+     *
+     * @param keyAlias The alias of the key in the KeyStore
+     * @param algorithm The signing algorithm
+     * @return The pipeline for the key
+     * @throws C2PAError.Api if [algorithm] is Ed25519
+     */
+    @JvmStatic
+    fun pipeline(keyAlias: String, algorithm: SigningAlgorithm): KeyStoreSigningPipeline =
+        pipelines.getOrPut("$keyAlias/${algorithm.description}") {
+            KeyStoreSigningPipeline(androidKeyStore, keyAlias, algorithm)
+        }
 
     /**
      * Create a signer with biometric authentication. Extracted from
@@ -225,49 +229,9 @@ object KeyStoreSigner {
         val keyStore = KeyStore.getInstance("AndroidKeyStore")
         keyStore.load(null)
         keyStore.deleteEntry(keyAlias)
+        pipelines.values.filter { it.keyAlias == keyAlias }.forEach { it.invalidate() }
         true
     } catch (e: Exception) {
         false
     }
-
-    private fun signWithKeyStore(
-        data: ByteArray,
-        keyAlias: String,
-        signatureAlgorithm: String,
-        c2paAlgorithm: SigningAlgorithm,
-    ): ByteArray {
-        val keyStore = KeyStore.getInstance("AndroidKeyStore")
-        keyStore.load(null)
-
-        val entry =
-            keyStore.getEntry(keyAlias, null) as? KeyStore.PrivateKeyEntry
-                ?: throw C2PAError.Api("Key '$keyAlias' not found in KeyStore")
-
-        val privateKey = entry.privateKey
-
-        val signature = Signature.getInstance(signatureAlgorithm)
-        signature.initSign(privateKey)
-        signature.update(data)
-        val signatureBytes = signature.sign()
-
-        // For ECDSA algorithms, convert from DER to raw format (r || s) for COSE
-        return if (c2paAlgorithm in
-            listOf(
-                SigningAlgorithm.ES256,
-                SigningAlgorithm.ES384,
-                SigningAlgorithm.ES512,
-            )
-        ) {
-            val componentLength =
-                when (c2paAlgorithm) {
-                    SigningAlgorithm.ES256 -> 32 // P-256
-                    SigningAlgorithm.ES384 -> 48 // P-384
-                    SigningAlgorithm.ES512 -> 66 // P-521
-                    else -> throw IllegalStateException()
-                }
-            derToRawSignature(signatureBytes, componentLength)
-        } else {
-            signatureBytes
-        }
-    }
 }
@@ -0,0 +1,144 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import java.security.KeyStore
+import java.security.PrivateKey
+import java.security.Signature
+
+/**
+ * Signs C2PA claims with one [KeyStore] key, caching everything that does not change between
+ * signatures.
+ *
+ * The private key entry is looked up once, each thread keeps its own initialized [Signature],
+ * and ECDSA signatures are converted from DER to the raw `r || s` form COSE requires in a single
+ * pass over a per-thread scratch buffer. Only the returned signature is allocated per call.
+ *
+ * The pipeline has no Android dependencies, so it works with any [KeyStore], including software
+ * keystores such as PKCS12 on a host JVM. [KeyStoreSigner] uses one pipeline per key alias for
+ * `AndroidKeyStore` keys.
+ *
+ * ```kotlin
+ * val pipeline = KeyStoreSigningPipeline(keyStore, "capture-key", SigningAlgorithm.ES256)
+ * val signer = pipeline.createSigner(certificateChainPEM)
+ * ```
+ *
+ * @property keyAlias The alias of the key in [keyStore]
+ * @property algorithm The signing algorithm
+ * @throws C2PAError.Api if [algorithm] is Ed25519, which KeyStore signing does not support
+ */
+class KeyStoreSigningPipeline @JvmOverloads constructor(
+    private val keyStore: KeyStore,
+    val keyAlias: String,
+    val algorithm: SigningAlgorithm,
+    private val password: CharArray? = null,
+) {
+    private class ThreadState(val key: PrivateKey, val signature: Signature) {
+        val derBuffer = ByteArray(MAX_DER_SIGNATURE_LENGTH)
+    }
+
+    private val signatureAlgorithm: String = signatureAlgorithmFor(algorithm)
+
+    // Zero for algorithms whose signatures are used as produced
+    private val componentLength: Int = when (algorithm) {
+        SigningAlgorithm.ES256 -> 32 // P-256
+        SigningAlgorithm.ES384 -> 48 // P-384
+        SigningAlgorithm.ES512 -> 66 // P-521
+        else -> 0
+    }
+
+    @Volatile
+    private var cachedKey: PrivateKey? = null
+
+    private val threadState = ThreadLocal<ThreadState>()
+
+    companion object {
+        // SEQUENCE header plus two INTEGERs of up to 67 bytes each, for P-521
+        private const val MAX_DER_SIGNATURE_LENGTH = 3 + 2 * (2 + 67)
+
+        /**
+         * Returns the JCA signature algorithm name for [algorithm].
+         *
+         * @throws C2PAError.Api if [algorithm] is Ed25519
+         */
+        @JvmStatic
+        fun signatureAlgorithmFor(algorithm: SigningAlgorithm): String = when (algorithm) {
+            SigningAlgorithm.ES256 -> "SHA256withECDSA"
+            SigningAlgorithm.ES384 -> "SHA384withECDSA"
+            SigningAlgorithm.ES512 -> "SHA512withECDSA"
+            SigningAlgorithm.PS256 -> "SHA256withRSA/PSS"
+            SigningAlgorithm.PS384 -> "SHA384withRSA/PSS"
+            SigningAlgorithm.PS512 -> "SHA512withRSA/PSS"
+            SigningAlgorithm.ED25519 ->
+                throw C2PAError.Api("Ed25519 not supported by Android KeyStore")
+        }
+    }
+
+    /**
+     * Signs [data], returning a signature in the form C2PA expects (raw `r || s` for ECDSA).
+     *
+     * @throws C2PAError.Api if the key is not in the keystore
+     */
+    fun sign(data: ByteArray): ByteArray {
+        val key = privateKey()
+        val state = threadState.get()?.takeIf { it.key === key }
+            ?: ThreadState(key, Signature.getInstance(signatureAlgorithm).apply { initSign(key) })
+                .also { threadState.set(it) }
+
+        val signature = state.signature
+        try {
+            signature.update(data)
+            if (componentLength == 0) {
+                return signature.sign()
+            }
+            // sign() leaves the Signature ready for the next message with the same key
+            val derLength = signature.sign(state.derBuffer, 0, state.derBuffer.size)
+            val raw = ByteArray(componentLength * 2)
+            derToRawSignature(state.derBuffer, 0, derLength, componentLength, raw, 0)
+            return raw
+        } catch (e: Exception) {
+            // The Signature state is unknown after a failure, and the key may have been invalidated
+            threadState.remove()
+            invalidate()
+            throw e
+        }
+    }
+
+    /**
+     * Creates a [Signer] backed by this pipeline.
+     *
+     * @param certificateChainPEM The certificate chain in PEM format
+     * @param tsaURL Optional timestamp authority URL
+     * @throws C2PAError.Api if the signer cannot be created
+     */
+    @JvmOverloads
+    @Throws(C2PAError::class)
+    fun createSigner(certificateChainPEM: String, tsaURL: String? = null): Signer =
+        Signer.withCallback(algorithm, certificateChainPEM, tsaURL) { data -> sign(data) }
+
+    /**
+     * Drops the cached key entry so that the next signature looks it up again, for example after
+     * the key has been replaced. Threads re-initialize their [Signature] on their next use.
+     */
+    fun invalidate() {
+        cachedKey = null
+    }
+
+    private fun privateKey(): PrivateKey {
+        cachedKey?.let { return it }
+        val entry = keyStore.getEntry(keyAlias, password?.let { KeyStore.PasswordProtection(it) })
+            as? KeyStore.PrivateKeyEntry
+            ?: throw C2PAError.Api("Key '$keyAlias' not found in KeyStore")
+        return entry.privateKey.also { cachedKey = it }
+    }
+}
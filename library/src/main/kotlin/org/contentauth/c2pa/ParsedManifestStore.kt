@@ -0,0 +1,149 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.channels.FileChannel
+import kotlin.concurrent.read
+
+/**
+ * A sidecar manifest store loaded once and bound to many assets.
+ *
+ * [Reader.fromManifestAndStream] takes the store as a byte array, which is copied across JNI
+ * for every asset. When one sidecar covers many renditions, or an asset is re-verified after an
+ * edit, load the store once here instead: it is kept in a direct buffer (a memory mapping when
+ * loaded from a file) that native code reads in place rather than receiving a copy. The Kotlin
+ * side indexes the manifests once, reading only box headers from the buffer, and checks the
+ * active manifest's claim signature once over a heap copy of that manifest alone.
+ *
+ * Native parsing and validation are not shared across [bind]: the native library parses the
+ * whole store again and validates it in full, including the claim signature and hard bindings,
+ * for every asset bound. What a store saves is the JNI copy, not the validation work.
+ *
+ * ```kotlin
+ * val store = ParsedManifestStore.fromFile(File("photo.c2pa"))
+ * renditions.forEach { file ->
+ *     Stream.fromInputStream(file.inputStream()).use { stream ->
+ *         store.bind("image/jpeg", stream).use { reader -> report(file, reader.json()) }
+ *     }
+ * }
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * A store may be bound from several threads at once. Each returned [Reader] belongs to the
+ * caller.
+ */
+class ParsedManifestStore private constructor(private val buffer: ByteBuffer) {
+
+    companion object {
+        init {
+            loadC2PALibraries()
+        }
+
+        /**
+         * Loads a manifest store from the remaining bytes of [buffer]. A direct buffer is used in
+         * place and must not be modified while the store is in use; a heap buffer is copied
+         * once.
+         *
+         * @throws C2PAError.Api if the bytes are not a C2PA manifest store
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        fun fromByteBuffer(buffer: ByteBuffer): ParsedManifestStore {
+            val direct = if (buffer.isDirect) {
+                buffer.slice()
+            } else {
+                ByteBuffer.allocateDirect(buffer.remaining()).put(buffer.duplicate()).also { it.flip() }
+            }
+            return ParsedManifestStore(direct)
+        }
+
+        /**
+         * Loads a manifest store by mapping [file] into memory. The file must not change while
+         * the store is in use.
+         *
+         * @throws C2PAError.Api if the file is not a C2PA manifest store
+         * @throws IOException if the file cannot be read
+         */
+        @JvmStatic
+        @Throws(C2PAError::class, IOException::class)
+        fun fromFile(file: File): ParsedManifestStore {
+            val mapped = RandomAccessFile(file, "r").use {
+                it.channel.map(FileChannel.MapMode.READ_ONLY, 0, it.length())
+            }
+            return ParsedManifestStore(mapped)
+        }
+
+        @JvmStatic
+        private external fun bindNative(
+            format: String,
+            streamHandle: Long,
+            manifestBuffer: ByteBuffer,
+            length: Long,
+        ): Long
+    }
+
+    private val manifests = ClaimSignatureVerifier.manifests(buffer)
+
+    init {
+        if (manifests.isEmpty()) throw C2PAError.Api("Not a C2PA manifest store")
+    }
+
+    /** The active manifest box, copied from the buffer on first use. */
+    private val activeManifest: ByteArray by lazy {
+        val range = manifests.values.last()
+        ByteArray(range.last - range.first + 1).also {
+            buffer.duplicate().apply { position(position() + range.first) }.get(it)
+        }
+    }
+
+    /** Size of the manifest store in bytes. */
+    val size: Int get() = buffer.remaining()
+
+    /** Labels of the manifests in the store, in store order. */
+    val manifestLabels: List<String> get() = manifests.keys.toList()
+
+    /** Label of the active manifest, which is the last in the store. */
+    val activeManifestLabel: String get() = manifests.keys.last()
+
+    /**
+     * The active manifest's claim, checked once against the signing certificate embedded in it.
+     * Like [Reader.integrityCheck], this is not a validation result and says nothing about trust;
+     * readers from [bind] are validated natively and report only in their JSON.
+     */
+    val integrityCheck: ClaimIntegrityCheck by lazy {
+        ClaimSignatureVerifier.verifyManifest(activeManifest, C2PA.defaultSignatureScope)
+    }
+
+    /**
+     * Validates [stream] against this store and returns a reader for the result.
+     *
+     * @param format The MIME type of the media (e.g., "image/jpeg", "image/png")
+     * @param stream The asset the store describes
+     * @return A Reader whose validation results cover this asset
+     * @throws C2PAError.Api if the store does not apply to the asset or the format is
+     * unsupported
+     */
+    @Throws(C2PAError::class)
+    fun bind(format: String, stream: Stream): Reader =
+        executeC2PAOperation("Failed to bind manifest store to stream") {
+            val handle = C2PA.globalSettingsLock.read {
+                bindNative(format, stream.rawPtr, buffer, buffer.remaining().toLong())
+            }
+            if (handle == 0L) null else Reader(handle)
+        }
+}
@@ -12,7 +12,20 @@ each license.
 
 package org.contentauth.c2pa
 
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.coroutines.sync.withPermit
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.contentOrNull
+import kotlinx.serialization.json.jsonObject
+import kotlinx.serialization.json.jsonPrimitive
 import java.io.Closeable
+import java.util.concurrent.ConcurrentHashMap
+import kotlin.concurrent.read
 
 /**
  * C2PA Reader for reading and validating manifest stores from media files.
@@ -52,6 +65,14 @@ import java.io.Closeable
  * val thumbnailBytes = outputStream.getData()
  * ```
  *
+ * ### Fast previews
+ *
+ * ```kotlin
+ * val reader = Reader.fromStream("image/jpeg", stream, VerificationLevel.SIGNATURE_ONLY)
+ * showPreview(reader.json(), reader.integrityCheck)
+ * withContext(Dispatchers.IO) { reader.upgrade() } // full validation, keeping the stream open
+ * ```
+ *
  * ## Thread Safety
  *
  * Reader instances are not thread-safe. Each thread should use its own Reader instance.
@@ -79,6 +100,9 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
          * This is the primary method for reading C2PA manifests from media files. The stream should
          * contain the complete media file (e.g., JPEG, PNG, MP4) with an embedded manifest.
          *
+         * The reader uses the process-default context, which reflects settings loaded with
+         * [C2PA.loadSettings]. Use [fromContext] to read with settings of your own.
+         *
          * @param format The MIME type of the media (e.g., "image/jpeg", "image/png", "video/mp4")
          * @param stream The input stream containing the media file
          * @return A Reader instance for accessing the manifest
@@ -97,10 +121,60 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
         @JvmStatic
         @Throws(C2PAError::class)
         fun fromStream(format: String, stream: Stream): Reader =
-            executeC2PAOperation("Failed to create reader from stream") {
-                val handle = fromStreamNative(format, stream.rawPtr)
-                if (handle == 0L) null else Reader(handle)
+            C2PA.defaultContext.withCurrentContext { fromContext(it) }
+                .withStream(format, stream)
+
+        /**
+         * Creates a reader that performs only the validation of [level].
+         *
+         * [VerificationLevel.STRUCTURE_ONLY] parses the manifest store without validating it.
+         * [VerificationLevel.SIGNATURE_ONLY] additionally checks the active claim signature,
+         * reading only the container structure of the asset rather than hashing it; the result is
+         * in [integrityCheck]. This is not a validation: the signing certificate is not checked
+         * against any trust list, so an intact claim says nothing about who signed it, and [json]
+         * has no validation results. JPEG and PNG support this level; other formats are fully
+         * validated instead. [VerificationLevel.FULL] is the same as [fromStream] without a level.
+         *
+         * A reader created below [VerificationLevel.FULL] keeps a reference to [stream] so that
+         * [upgrade] can finish the skipped work; keep the stream open until then.
+         *
+         * Claim checks are memoized in the [C2PAContext.signatureCache] of [context], keyed by
+         * that context's trust settings, so an ingredient manifest carried by many assets is
+         * checked once. The default is the process-default context. Only the cache is taken from
+         * [context]; the manifest store is parsed without validation whatever its settings.
+         *
+         * @param format The MIME type of the media (e.g., "image/jpeg", "image/png")
+         * @param stream The input stream containing the media file
+         * @param level How much validation to perform now
+         * @param context Context whose signature cache to use, or null for the process default
+         * @return A Reader instance for accessing the manifest
+         * @throws C2PAError.Api if the stream doesn't contain a C2PA manifest or the format is
+         * unsupported
+         */
+        @JvmStatic
+        @JvmOverloads
+        @Throws(C2PAError::class)
+        fun fromStream(
+            format: String,
+            stream: Stream,
+            level: VerificationLevel,
+            context: C2PAContext? = null,
+        ): Reader {
+            if (level == VerificationLevel.FULL) return fromStream(format, stream)
+            val reader = fromContext(structureOnlyContext).withStream(format, stream)
+            reader.verificationLevel = VerificationLevel.STRUCTURE_ONLY
+            reader.source = format to stream
+            reader.signatureCache = context?.signatureScope ?: C2PA.defaultSignatureScope
+            return reader.upgrade(level)
+        }
+
+        // Parses manifest stores without validating them, for levels below FULL
+        private val structureOnlyContext: C2PAContext by lazy {
+            C2PASettings.create().use { settings ->
+                settings.setValue("verify.verify_after_reading", "false")
+                C2PAContext.fromSettings(settings)
             }
+        }
 
         /**
          * Creates a reader from a shared [C2PAContext].
@@ -130,7 +204,7 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
         fun fromContext(context: C2PAContext): Reader =
             executeC2PAOperation("Failed to create reader from context") {
                 val handle = nativeFromContext(context.ptr)
-                if (handle == 0L) null else Reader(handle)
+                if (handle == 0L) null else Reader(handle).also { it.revocationIndex = context.revocationIndex }
             }
 
         /**
@@ -157,14 +231,14 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
         @Throws(C2PAError::class)
         fun fromManifestAndStream(format: String, stream: Stream, manifest: ByteArray): Reader =
             executeC2PAOperation("Failed to create reader from manifest and stream") {
-                val handle = fromManifestDataAndStreamNative(format, stream.rawPtr, manifest)
+                val handle = C2PA.globalSettingsLock.read {
+                    fromManifestDataAndStreamNative(format, stream.rawPtr, manifest)
+                }
                 if (handle == 0L) null else Reader(handle)
             }
 
         @JvmStatic private external fun nativeFromContext(contextPtr: Long): Long
 
-        @JvmStatic private external fun fromStreamNative(format: String, streamHandle: Long): Long
-
         @JvmStatic
         private external fun fromManifestDataAndStreamNative(
             format: String,
@@ -173,6 +247,221 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
         ): Long
     }
 
+    /** The validation this reader has performed. Readers not created with a level are [VerificationLevel.FULL]. */
+    var verificationLevel: VerificationLevel = VerificationLevel.FULL
+        private set
+
+    /**
+     * The claim check from [VerificationLevel.SIGNATURE_ONLY], or null if not made. Cleared by
+     * [upgrade] to [VerificationLevel.FULL], whose results are the native ones in [json].
+     */
+    var integrityCheck: ClaimIntegrityCheck? = null
+        private set
+
+    /**
+     * The active manifest's signing certificate chain checked against the
+     * [C2PAContext.revocationIndex] of the context this reader was created from, or null if the
+     * context has none, the manifest has no chain, or the chain could not be read from the asset
+     * (formats other than JPEG and PNG, or remote manifests).
+     *
+     * The chain is read once, when the stream is set. The result is reported only here: the
+     * native validation in [json], [detailedJson] and [cbor] has no revocation hook and is
+     * returned unchanged, so check this before trusting a valid result.
+     */
+    var revocationCheck: RevocationCheck? = null
+        private set
+
+    private var revocationIndex: RevocationIndex? = null
+
+    // Retained by readers below FULL so that upgrade can finish the work
+    private var source: Pair<String, Stream>? = null
+
+    // Memo of claim signature checks for readers below FULL
+    private var signatureCache: SignatureVerificationCache.Scope? = null
+
+    // Raw manifest store, located for signature checks below FULL
+    private var manifestStore: ByteArray? = null
+    private var manifestRanges: Map<String, IntRange>? = null
+
+    // Ingredient claim checks by manifest label, shared by ingredient() and checkIngredientClaimSignatures()
+    private val ingredientChecks = ConcurrentHashMap<String, ClaimIntegrityCheck>()
+
+    private var ingredients: List<JsonObject>? = null
+
+    /**
+     * An ingredient of the active manifest.
+     *
+     * @property index Position in the active manifest's ingredient list
+     * @property title The ingredient's title, if it has one
+     * @property manifestLabel Label of the ingredient's own manifest, or null if it has none
+     * @property json The ingredient as a JSON object
+     * @property integrityCheck Result of checking the ingredient manifest's claim against its own
+     * embedded certificate, or null if it has no manifest or the reader is at
+     * [VerificationLevel.FULL]. Like [Reader.integrityCheck], this is not a validation result
+     */
+    data class Ingredient(
+        val index: Int,
+        val title: String?,
+        val manifestLabel: String?,
+        val json: String,
+        val integrityCheck: ClaimIntegrityCheck?,
+    )
+
+    /**
+     * Returns the number of ingredients of the active manifest.
+     *
+     * @throws C2PAError.Api if the manifest cannot be read
+     */
+    @Throws(C2PAError::class)
+    fun ingredientCount(): Int = activeIngredients().size
+
+    /**
+     * Returns ingredient [index] of the active manifest.
+     *
+     * For a reader created below [VerificationLevel.FULL], only the claim signature of the
+     * ingredient's manifest is checked, on first request rather than when the reader was created;
+     * the result is reused. A reader created at [VerificationLevel.FULL] has had every ingredient validated
+     * natively, one after another, while it was created; those results are in [json].
+     *
+     * @throws C2PAError.Api if the manifest cannot be read or [index] is out of range
+     */
+    @Throws(C2PAError::class)
+    fun ingredient(index: Int): Ingredient {
+        val list = activeIngredients()
+        if (index !in list.indices) {
+            throw C2PAError.Api("Ingredient index $index out of range (${list.size} ingredients)")
+        }
+        val ingredient = list[index]
+        val label = ingredient["active_manifest"]?.jsonPrimitive?.contentOrNull
+        return Ingredient(
+            index = index,
+            title = ingredient["title"]?.jsonPrimitive?.contentOrNull,
+            manifestLabel = label,
+            json = ingredient.toString(),
+            integrityCheck = label?.let { label ->
+                locateManifests()?.let { (store, ranges) -> checkIngredientClaim(label, store, ranges) }
+            },
+        )
+    }
+
+    /**
+     * Checks only the claim signature of every ingredient manifest in the store, at any depth,
+     * with up to [parallelism] checks running at once on [Dispatchers.Default].
+     *
+     * This is not ingredient validation. Like [VerificationLevel.SIGNATURE_ONLY], each claim is
+     * checked on the Kotlin side against its own embedded certificate; ingredient hashes,
+     * certificate chains and trust are not validated. Full validation of ingredients is done by
+     * [upgrade], in the native library, which still validates them one after another.
+     *
+     * Returns an empty map for readers created at [VerificationLevel.FULL], or when the manifest
+     * store cannot be located in the asset.
+     *
+     * @param parallelism Maximum number of claim signatures checked at once
+     * @return Claim checks keyed by manifest label
+     */
+    suspend fun checkIngredientClaimSignatures(
+        parallelism: Int = Runtime.getRuntime().availableProcessors(),
+    ): Map<String, ClaimIntegrityCheck> {
+        require(parallelism > 0) { "parallelism must be positive" }
+        val (store, ranges) = locateManifests() ?: return emptyMap()
+        // The active manifest is last in the store and is covered by integrityCheck
+        val labels = ranges.keys.toList().dropLast(1)
+        val permits = Semaphore(parallelism)
+        return coroutineScope {
+            labels.map { label ->
+                async(Dispatchers.Default) {
+                    permits.withPermit { label to checkIngredientClaim(label, store, ranges) }
+                }
+            }.awaitAll().toMap()
+        }
+    }
+
+    private fun activeIngredients(): List<JsonObject> {
+        ingredients?.let { return it }
+        val store = C2PAJson.default.parseToJsonElement(json()).jsonObject
+        val activeLabel = store["active_manifest"]?.jsonPrimitive?.content
+        val active = activeLabel?.let { store["manifests"]?.jsonObject?.get(it)?.jsonObject }
+        val list = (active?.get("ingredients") as? JsonArray)?.map { it.jsonObject } ?: emptyList()
+        ingredients = list
+        return list
+    }
+
+    private fun checkIngredientClaim(
+        label: String,
+        store: ByteArray,
+        ranges: Map<String, IntRange>,
+    ): ClaimIntegrityCheck {
+        ingredientChecks[label]?.let { return it }
+        val range = ranges[label]
+        val check = if (range == null) {
+            ClaimIntegrityCheck(false, message = "Ingredient manifest $label is not in the manifest store")
+        } else {
+            ClaimSignatureVerifier.verifyManifest(store.copyOfRange(range.first, range.last + 1), signatureCache)
+        }
+        return ingredientChecks.putIfAbsent(label, check) ?: check
+    }
+
+    @Synchronized
+    private fun locateManifestStore(): ByteArray? {
+        manifestStore?.let { return it }
+        val (format, stream) = source ?: return null
+        return ClaimSignatureVerifier.extractManifestStore(format, stream)?.also { manifestStore = it }
+    }
+
+    /** Returns the manifest store and the range of each manifest in it, indexing the store once. */
+    private fun locateManifests(): Pair<ByteArray, Map<String, IntRange>>? {
+        val store = locateManifestStore() ?: return null
+        val ranges = manifestRanges ?: ClaimSignatureVerifier.manifests(store).also { manifestRanges = it }
+        return store to ranges
+    }
+
+    /**
+     * Performs the validation skipped when this reader was created, up to [level].
+     *
+     * Upgrading to [VerificationLevel.FULL] re-reads the stream with full validation and replaces
+     * this reader's contents, so [json] then includes validation results. Upgrading to a level at
+     * or below the current one does nothing. This blocks for the duration of the work; call it
+     * from a background thread and do not use the reader meanwhile.
+     *
+     * @param level The level to reach
+     * @return This reader for fluent chaining
+     * @throws C2PAError.Api if validation cannot be performed, for example because the stream
+     * was closed
+     */
+    @Throws(C2PAError::class)
+    fun upgrade(level: VerificationLevel = VerificationLevel.FULL): Reader {
+        if (level <= verificationLevel) return this
+        val (format, stream) = source ?: throw C2PAError.Api("Reader has no stream to upgrade from")
+
+        if (level == VerificationLevel.SIGNATURE_ONLY) {
+            val store = try {
+                locateManifestStore()
+            } catch (e: Exception) {
+                throw C2PAError.Api("Failed to read manifest store: ${e.message}")
+            }
+            if (store != null) {
+                integrityCheck = ClaimSignatureVerifier.verify(store, signatureCache)
+                verificationLevel = VerificationLevel.SIGNATURE_ONLY
+                return this
+            }
+            // The signature cannot be checked on its own for this asset; validate fully instead
+        }
+
+        stream.seek(0, SeekMode.START.value)
+        val full = fromStream(format, stream)
+        if (ptr != 0L) free(ptr)
+        ptr = full.ptr
+        full.ptr = 0
+        integrityCheck = null
+        ingredientChecks.clear()
+        manifestStore = null
+        manifestRanges = null
+        ingredients = null
+        verificationLevel = VerificationLevel.FULL
+        source = null
+        return this
+    }
+
     /**
      * Configures the reader with a media stream.
      *
@@ -196,6 +485,12 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
             throw C2PAError.Api(C2PA.getError() ?: "Failed to configure reader with stream")
         }
         ptr = newPtr
+        revocationIndex?.let { index ->
+            revocationCheck = ClaimSignatureVerifier.extractManifestStore(format, stream)
+                ?.let { ClaimSignatureVerifier.signingChain(it) }
+                ?.takeIf { it.isNotEmpty() }
+                ?.let { index.check(it) }
+        }
         return this
     }
 
@@ -293,6 +588,35 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
         return json
     }
 
+    /**
+     * Returns the manifest store encoded as CBOR.
+     *
+     * The content is the same as [json]. The native library still produces JSON, which is
+     * transcoded to CBOR in native code, so this costs more native work than [json]; what it
+     * saves is the Java string and its parse on the Kotlin side. Decode it with [C2PACbor] or
+     * [org.contentauth.c2pa.manifest.ManifestStoreView.fromCbor].
+     *
+     * @return The manifest store as CBOR
+     * @throws C2PAError.Api if the manifest cannot be serialized
+     *
+     * @sample
+     * ```kotlin
+     * val reader = Reader.fromStream("image/jpeg", stream)
+     * val store = C2PACbor.decodeToJsonElement(reader.cbor()).jsonObject
+     * val activeLabel = store["active_manifest"]?.jsonPrimitive?.content
+     * ```
+     *
+     * @see json
+     */
+    @Throws(C2PAError::class)
+    fun cbor(): ByteArray {
+        val cbor = toCborNative(ptr)
+        if (cbor == null) {
+            throw C2PAError.Api(C2PA.getError() ?: "Failed to convert to CBOR")
+        }
+        return cbor
+    }
+
     /**
      * Returns the remote URL where the manifest is hosted, if available.
      *
@@ -384,6 +708,7 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
      * leaks. It's safe to call this method multiple times.
      */
     override fun close() {
+        source = null
         if (ptr != 0L) {
             free(ptr)
             ptr = 0
@@ -395,6 +720,7 @@ class Reader internal constructor(private var ptr: Long) : Closeable {
     private external fun withFragmentNative(handle: Long, format: String, streamHandle: Long, fragmentHandle: Long): Long
     private external fun toJsonNative(handle: Long): String?
     private external fun toDetailedJsonNative(handle: Long): String?
+    private external fun toCborNative(handle: Long): ByteArray?
     private external fun remoteUrlNative(handle: Long): String?
     private external fun isEmbeddedNative(handle: Long): Boolean
     private external fun resourceToStreamNative(handle: Long, uri: String, streamHandle: Long): Long
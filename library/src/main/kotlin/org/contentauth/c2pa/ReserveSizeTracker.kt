@@ -0,0 +1,399 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlin.math.ceil
+import kotlin.math.max
+
+/**
+ * Sizes the signature reserve of a [Signer] from the signatures it has actually produced.
+ *
+ * [Signer.reserveSize] is a fixed upper bound that leaves room for the largest signature, time
+ * stamp token and certificate chain the signer could produce. A data-hashed placeholder sized with
+ * it is padded to that bound, which can be several kilobytes more than the signature needs. The
+ * tracker records the layout of each signature the signer produces — the raw signature, the TSA
+ * token, OCSP data and the certificate chain — and recommends the largest signature seen plus a
+ * safety margin, never exceeding the fixed bound.
+ *
+ * The margin is the larger of [marginFraction] of the largest signature, [minimumMargin], and
+ * the largest time stamp token plus OCSP data seen. Those two parts come from outside services and
+ * can grow between signatures (a TSA rotating to a longer chain, a bigger OCSP response), so the
+ * recommendation leaves room for them to double. A placeholder that is still too small makes
+ * [Builder.signDataHashedEmbeddable] fail; retry with [Signer.reserveSize].
+ *
+ * Every [Signer] has a tracker, fed by [Builder.sign] and [Builder.signDataHashedEmbeddable].
+ * Parsing a signature to record it costs a pass over the manifest store, so the builder only
+ * records once the tracker is in use: from the first call to [reserveSize] or [stats] (and so
+ * [Signer.adaptiveReserveSize]) on. Signatures made before that are not observed.
+ * Size placeholders for later signatures with [Signer.adaptiveReserveSize]:
+ *
+ * ```kotlin
+ * val placeholder = builder.dataHashedPlaceholder(signer.adaptiveReserveSize().toLong(), "image/jpeg")
+ * ```
+ *
+ * The recommendation only applies to the reserve the caller passes to
+ * [Builder.dataHashedPlaceholder]; embedded signing through [Builder.sign] sizes its own reserve
+ * in the native library.
+ *
+ * @param fixedReserveSize Supplies the signer's fixed upper bound
+ * @param marginFraction Extra room relative to the largest signature seen
+ * @param minimumMargin Minimum extra room in bytes
+ * @param minimumSamples Signatures to observe before the recommendation drops below the fixed bound
+ */
+class ReserveSizeTracker @JvmOverloads constructor(
+    private val fixedReserveSize: () -> Int,
+    private val marginFraction: Double = 0.1,
+    private val minimumMargin: Int = 512,
+    private val minimumSamples: Int = 1,
+) {
+
+    /**
+     * Observed signature sizes.
+     *
+     * @property samples Number of signatures recorded
+     * @property maxSignatureBytes Largest raw signature
+     * @property maxTimestampBytes Largest encoded time stamp token (0 without a TSA)
+     * @property maxOcspBytes Largest encoded OCSP data (0 if none was stapled)
+     * @property maxCertificateChainBytes Largest encoded certificate chain
+     * @property maxCoseBytes Largest COSE signature, excluding padding
+     * @property fixedReserveSize The signer's fixed upper bound
+     * @property reserveSize The currently recommended reserve
+     */
+    data class Stats(
+        val samples: Long,
+        val maxSignatureBytes: Int,
+        val maxTimestampBytes: Int,
+        val maxOcspBytes: Int,
+        val maxCertificateChainBytes: Int,
+        val maxCoseBytes: Int,
+        val fixedReserveSize: Int,
+        val reserveSize: Int,
+    ) {
+        /** Bytes saved per placeholder compared to the fixed bound. */
+        val savedBytes: Int get() = fixedReserveSize - reserveSize
+    }
+
+    private var samples = 0L
+    private var maxSignature = 0
+    private var maxTimestamp = 0
+    private var maxOcsp = 0
+    private var maxCertificateChain = 0
+    private var maxCose = 0
+
+    @Volatile
+    private var cachedFixedReserve = -1
+
+    @Volatile
+    private var tracking = false
+
+    init {
+        require(marginFraction >= 0) { "marginFraction must not be negative" }
+        require(minimumMargin >= 0) { "minimumMargin must not be negative" }
+    }
+
+    /**
+     * Returns the recommended reserve size in bytes: the fixed bound until [minimumSamples]
+     * signatures have been seen, then the largest observed signature plus the margin.
+     *
+     * @throws C2PAError.Api if the fixed bound cannot be read from the signer
+     */
+    @Throws(C2PAError::class)
+    fun reserveSize(): Int {
+        tracking = true
+        val fixed = fixedReserve()
+        synchronized(this) {
+            return recommend(fixed)
+        }
+    }
+
+    /** Returns the sizes observed so far. */
+    @Throws(C2PAError::class)
+    fun stats(): Stats {
+        tracking = true
+        val fixed = fixedReserve()
+        synchronized(this) {
+            return Stats(
+                samples = samples,
+                maxSignatureBytes = maxSignature,
+                maxTimestampBytes = maxTimestamp,
+                maxOcspBytes = maxOcsp,
+                maxCertificateChainBytes = maxCertificateChain,
+                maxCoseBytes = maxCose,
+                fixedReserveSize = fixed,
+                reserveSize = recommend(fixed),
+            )
+        }
+    }
+
+    /**
+     * Records the signature in a signed manifest store. Manifests whose signature cannot be located
+     * are ignored.
+     *
+     * @param manifest The JUMBF manifest store returned by signing
+     * @return Whether a signature was found and recorded
+     */
+    fun record(manifest: ByteArray): Boolean {
+        val layout = try {
+            CoseSignatureLayout.fromManifestStore(manifest)
+        } catch (e: IndexOutOfBoundsException) {
+            null
+        } catch (e: IllegalArgumentException) {
+            null
+        } ?: return false
+        synchronized(this) {
+            samples++
+            maxSignature = max(maxSignature, layout.signature)
+            maxTimestamp = max(maxTimestamp, layout.timestamp)
+            maxOcsp = max(maxOcsp, layout.ocsp)
+            maxCertificateChain = max(maxCertificateChain, layout.certificateChain)
+            maxCose = max(maxCose, layout.total - layout.padding)
+        }
+        return true
+    }
+
+    /** Records [manifest] if the tracker is in use; called by [Builder] after every sign. */
+    internal fun observe(manifest: ByteArray) {
+        if (tracking) record(manifest)
+    }
+
+    /** Forgets all observations, for example after the signer's certificate or TSA changes. */
+    fun reset() {
+        synchronized(this) {
+            samples = 0
+            maxSignature = 0
+            maxTimestamp = 0
+            maxOcsp = 0
+            maxCertificateChain = 0
+            maxCose = 0
+        }
+    }
+
+    private fun fixedReserve(): Int {
+        val cached = cachedFixedReserve
+        if (cached >= 0) return cached
+        return fixedReserveSize().also { cachedFixedReserve = it }
+    }
+
+    private fun recommend(fixed: Int): Int {
+        if (samples < minimumSamples || maxCose == 0) return fixed
+        val margin = maxOf(ceil(maxCose * marginFraction).toInt(), minimumMargin, maxTimestamp + maxOcsp)
+        return minOf(maxCose + margin, fixed)
+    }
+}
+
+/**
+ * Locates the active manifest's COSE signature in a JUMBF manifest store and measures its parts.
+ */
+internal object CoseSignatureLayout {
+
+    data class Sizes(
+        val total: Int,
+        val signature: Int,
+        val certificateChain: Int,
+        val timestamp: Int,
+        val ocsp: Int,
+        val padding: Int,
+    )
+
+    private const val SIGNATURE_LABEL = "c2pa.signature"
+    private val JUMD = "jumd".toByteArray()
+    private val CBOR = "cbor".toByteArray()
+
+    // COSE header label for x5chain
+    private const val X5CHAIN = 33L
+
+    // LBox, TBox, UUID and toggles precede the label in a JUMBF description box
+    private const val LABEL_OFFSET = 4 + 4 + 16 + 1
+
+    /** Returns the signature layout, or null if no signature box is found. */
+    fun fromManifestStore(store: ByteArray): Sizes? {
+        val content = lastCborBox(store, SIGNATURE_LABEL) ?: return null
+        return parseCoseSign1(store, content.first, content.last + 1)
+    }
+
+    /**
+     * Returns the range of the CBOR content of the last JUMBF box labelled [label], or null if
+     * there is none. The active manifest is the last one in a store, so this finds its box.
+     */
+    fun lastCborBox(store: ByteArray, label: String): IntRange? {
+        val labelOffset = lastIndexOf(store, label.toByteArray() + 0.toByte())
+        if (labelOffset < LABEL_OFFSET) return null
+        val description = labelOffset - LABEL_OFFSET
+        if (!matches(store, description + 4, JUMD)) return null
+        val content = description + readInt(store, description)
+        val contentLength = readInt(store, content)
+        if (contentLength < 8 || !matches(store, content + 4, CBOR)) return null
+        val end = content + contentLength
+        require(end <= store.size) { "Truncated $label box" }
+        return (content + 8) until end
+    }
+
+    private fun parseCoseSign1(bytes: ByteArray, start: Int, end: Int): Sizes {
+        val reader = CborSpanReader(bytes, start, end)
+        var head = reader.readHead()
+        if (head.major == CborSpanReader.TAG) head = reader.readHead()
+        require(head.major == CborSpanReader.ARRAY && head.value == 4L) { "Not a COSE_Sign1" }
+
+        var certificateChain = 0
+        var timestamp = 0
+        var ocsp = 0
+        var padding = 0
+
+        // Protected header: a byte string holding a map
+        val protectedHead = reader.readHead()
+        require(protectedHead.major == CborSpanReader.BYTES) { "Invalid protected header" }
+        val protectedEnd = reader.position + protectedHead.value.toInt()
+        if (protectedHead.value > 0) {
+            val protectedReader = CborSpanReader(bytes, reader.position, protectedEnd)
+            certificateChain += protectedReader.measureMap { key, span, _ -> if (key == X5CHAIN) span else 0 }
+        }
+        reader.position = protectedEnd
+
+        // Unprotected header
+        reader.measureMap { key, span, valueLength ->
+            when (key) {
+                X5CHAIN -> certificateChain += span
+                "sigTst", "sigTst2" -> timestamp += span
+                "rVals" -> ocsp += span
+                "pad", "pad2" -> padding += valueLength
+            }
+            0
+        }
+
+        reader.skip() // Detached payload
+
+        val signatureHead = reader.readHead()
+        require(signatureHead.major == CborSpanReader.BYTES) { "Invalid signature" }
+        reader.position += signatureHead.value.toInt()
+
+        return Sizes(
+            total = reader.position - start,
+            signature = signatureHead.value.toInt(),
+            certificateChain = certificateChain,
+            timestamp = timestamp,
+            ocsp = ocsp,
+            padding = padding,
+        )
+    }
+
+    private fun readInt(bytes: ByteArray, offset: Int): Int =
+        ((bytes[offset].toInt() and 0xFF) shl 24) or
+            ((bytes[offset + 1].toInt() and 0xFF) shl 16) or
+            ((bytes[offset + 2].toInt() and 0xFF) shl 8) or
+            (bytes[offset + 3].toInt() and 0xFF)
+
+    private fun matches(bytes: ByteArray, offset: Int, expected: ByteArray): Boolean =
+        offset + expected.size <= bytes.size && expected.indices.all { bytes[offset + it] == expected[it] }
+
+    private fun lastIndexOf(bytes: ByteArray, pattern: ByteArray): Int {
+        for (i in bytes.size - pattern.size downTo 0) {
+            if (matches(bytes, i, pattern)) return i
+        }
+        return -1
+    }
+
+    /** Walks definite-length CBOR, measuring the encoded size of items. */
+    class CborSpanReader(private val bytes: ByteArray, var position: Int, private val end: Int) {
+        class Head(val major: Int, val value: Long)
+
+        companion object {
+            const val UNSIGNED = 0
+            const val NEGATIVE = 1
+            const val BYTES = 2
+            const val TEXT = 3
+            const val ARRAY = 4
+            const val MAP = 5
+            const val TAG = 6
+        }
+
+        fun readHead(): Head {
+            require(position < end) { "Unexpected end of CBOR" }
+            val initial = bytes[position++].toInt() and 0xFF
+            val major = initial shr 5
+            val info = initial and 0x1F
+            val value = when {
+                info < 24 -> info.toLong()
+                info == 24 -> readBigEndian(1)
+                info == 25 -> readBigEndian(2)
+                info == 26 -> readBigEndian(4)
+                info == 27 -> readBigEndian(8)
+                else -> throw IllegalArgumentException("Indefinite-length CBOR is not supported")
+            }
+            return Head(major, value)
+        }
+
+        private fun readBigEndian(count: Int): Long {
+            require(position + count <= end) { "Unexpected end of CBOR" }
+            var value = 0L
+            repeat(count) { value = (value shl 8) or (bytes[position++].toLong() and 0xFF) }
+            return value
+        }
+
+        /** Reads a byte string item and returns its content. */
+        fun readBytes(): ByteArray {
+            val head = readHead()
+            require(head.major == BYTES) { "Expected a CBOR byte string" }
+            require(position + head.value <= end) { "Unexpected end of CBOR" }
+            return bytes.copyOfRange(position, position + head.value.toInt()).also { position += it.size }
+        }
+
+        fun skip() {
+            val head = readHead()
+            when (head.major) {
+                BYTES, TEXT -> position += head.value.toInt()
+                ARRAY -> repeat(head.value.toInt()) { skip() }
+                MAP -> repeat(head.value.toInt() * 2) { skip() }
+                TAG -> skip()
+            }
+            require(position <= end) { "Unexpected end of CBOR" }
+        }
+
+        /**
+         * Visits each entry of a map with its key (a Long or String, or null for other key types),
+         * the encoded size of its value, and the content length of byte or text string values.
+         * Returns the sum of the visitor's results.
+         */
+        fun measureMap(visit: (key: Any?, span: Int, valueLength: Int) -> Int): Int {
+            val head = readHead()
+            require(head.major == MAP) { "Expected a CBOR map" }
+            var total = 0
+            repeat(head.value.toInt()) {
+                val key = readKey()
+                val valueStart = position
+                val valueHead = readHead()
+                position = valueStart
+                skip()
+                val valueLength =
+                    if (valueHead.major == BYTES || valueHead.major == TEXT) valueHead.value.toInt() else 0
+                total += visit(key, position - valueStart, valueLength)
+            }
+            return total
+        }
+
+        private fun readKey(): Any? {
+            val start = position
+            val head = readHead()
+            return when (head.major) {
+                UNSIGNED -> head.value
+                TEXT -> String(bytes, position, head.value.toInt(), Charsets.UTF_8).also {
+                    position += head.value.toInt()
+                }
+                else -> {
+                    position = start
+                    skip()
+                    null
+                }
+            }
+        }
+    }
+}
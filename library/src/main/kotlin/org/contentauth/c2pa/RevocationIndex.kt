@@ -0,0 +1,456 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import java.io.ByteArrayInputStream
+import java.io.DataOutputStream
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.math.BigInteger
+import java.nio.ByteBuffer
+import java.nio.MappedByteBuffer
+import java.nio.channels.FileChannel
+import java.nio.file.Files
+import java.nio.file.StandardCopyOption
+import java.security.GeneralSecurityException
+import java.security.MessageDigest
+import java.security.cert.CRLException
+import java.security.cert.CRLReason
+import java.security.cert.CertificateFactory
+import java.security.cert.X509CRL
+import java.security.cert.X509Certificate
+import javax.security.auth.x500.X500Principal
+
+/** Revocation status of a certificate according to a [RevocationIndex]. */
+enum class RevocationStatus {
+    /** The issuer's CRL is in the index and does not list the certificate. */
+    GOOD,
+
+    /** The certificate is listed as revoked. */
+    REVOKED,
+
+    /** The index has no CRL for the certificate's issuer. */
+    UNKNOWN,
+}
+
+/**
+ * Result of checking a signing certificate chain against a [RevocationIndex].
+ *
+ * @property status The chain's status
+ * @property subject Subject of the certificate that determined [status], if it is not GOOD
+ */
+data class RevocationCheck(val status: RevocationStatus, val subject: String? = null)
+
+/**
+ * Offline certificate revocation index compiled from CRLs.
+ *
+ * OCSP checking ([org.contentauth.c2pa.settings.OcspFetchScope]) needs the network for every
+ * asset, and fetching CRLs per asset is impractical. A revocation index is compiled once from
+ * the CRLs of the issuers an app trusts and memory-mapped, so lookups read a few pages of a file
+ * instead of parsing CRLs or making requests. Each issuer's revoked serial numbers are stored
+ * sorted, and a Bloom filter over all (issuer, serial) pairs answers most lookups for
+ * unrevoked certificates without searching the lists.
+ *
+ * Refresh an index with [applyDelta] as delta CRLs or new full CRLs arrive; this writes a new
+ * file and leaves the open index usable. Every CRL must be signed by one of the trusted issuer
+ * certificates passed with it, usually the trust anchors and intermediate CAs configured in the
+ * trust settings; a CRL whose signature does not verify against one of them is rejected.
+ *
+ * Attach an index to a context with [C2PAContext.fromSettings]; readers created from that
+ * context then report [Reader.revocationCheck]. The native validation report is not changed: its
+ * chain validation has no revocation hook, so a revoked signer is only reported there.
+ *
+ * ```kotlin
+ * val index = RevocationIndex.compile(listOf(crlBytes), trustedIssuers, File(filesDir, "revocation.idx"))
+ * val context = C2PAContext.fromSettings(settings, index)
+ * Reader.fromContext(context).withStream("image/jpeg", stream).use { reader ->
+ *     if (reader.revocationCheck?.status == RevocationStatus.REVOKED) rejectAsset()
+ * }
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * Lookups are thread-safe.
+ */
+class RevocationIndex private constructor(
+    /** The file the index was loaded from. */
+    val file: File,
+    private val buffer: ByteBuffer,
+) {
+
+    /** Number of issuers with a CRL in the index. */
+    val issuerCount: Int = buffer.getInt(ISSUER_COUNT_OFFSET)
+
+    private val bloomWords = buffer.getInt(BLOOM_WORDS_OFFSET)
+    private val bloomHashes = buffer.getInt(BLOOM_HASHES_OFFSET)
+    private val bloomOffset = HEADER_SIZE + issuerCount * ISSUER_ENTRY_SIZE
+    private val bloomMask = bloomWords.toLong() * 64 - 1
+
+    companion object {
+        private val MAGIC = "C2PARVIX".toByteArray(Charsets.US_ASCII)
+        private const val VERSION = 1
+
+        // Header: magic, version, issuer count, Bloom filter size in 64-bit words, hash count
+        private const val ISSUER_COUNT_OFFSET = 12
+        private const val BLOOM_WORDS_OFFSET = 16
+        private const val BLOOM_HASHES_OFFSET = 20
+        private const val HEADER_SIZE = 24
+
+        // Issuer entry: key, serials offset, serial count, serial width, next update
+        private const val KEY_SIZE = 32
+        private const val ISSUER_ENTRY_SIZE = KEY_SIZE + 8 + 4 + 4 + 8
+
+        // About 1% false positives
+        private const val BLOOM_BITS_PER_ENTRY = 10
+        private const val BLOOM_HASHES = 7
+
+        private const val DELTA_CRL_INDICATOR = "2.5.29.27"
+
+        /**
+         * Compiles [crls], each DER or PEM encoded, into an index at [output] and opens it.
+         *
+         * Several CRLs from one issuer, such as partitioned CRLs, are merged. Entries of indirect
+         * CRLs are filed under their certificate issuer.
+         *
+         * @param crls The CRLs to index
+         * @param trustedIssuers Certificates allowed to sign [crls]; each CRL must verify against
+         * one whose subject is the CRL's issuer
+         * @param output The index file to write
+         * @throws C2PAError.Api if a CRL cannot be parsed or is not signed by a trusted issuer
+         * @throws IOException if the index cannot be written
+         */
+        @JvmStatic
+        @Throws(C2PAError::class, IOException::class)
+        fun compile(crls: List<ByteArray>, trustedIssuers: List<X509Certificate>, output: File): RevocationIndex {
+            val issuers = HashMap<ByteBuffer, IssuerEntries>()
+            parseCrls(crls, trustedIssuers).forEach { merge(issuers, it) }
+            write(issuers, output)
+            return open(output)
+        }
+
+        /**
+         * Opens an index written by [compile] or [applyDelta] by mapping it into memory.
+         *
+         * @throws C2PAError.Api if the file is not a revocation index
+         * @throws IOException if the file cannot be read
+         */
+        @JvmStatic
+        @Throws(C2PAError::class, IOException::class)
+        fun open(file: File): RevocationIndex {
+            val buffer: MappedByteBuffer = RandomAccessFile(file, "r").use {
+                it.channel.map(FileChannel.MapMode.READ_ONLY, 0, it.length())
+            }
+            val magic = ByteArray(MAGIC.size)
+            if (buffer.capacity() < HEADER_SIZE) throw C2PAError.Api("Not a revocation index: $file")
+            buffer.duplicate().get(magic)
+            if (!magic.contentEquals(MAGIC) || buffer.getInt(MAGIC.size) != VERSION) {
+                throw C2PAError.Api("Not a revocation index: $file")
+            }
+            return RevocationIndex(file, buffer)
+        }
+
+        private class IssuerEntries(var nextUpdate: Long) {
+            val serials = HashSet<ByteBuffer>()
+        }
+
+        private fun parseCrls(crls: List<ByteArray>, trustedIssuers: List<X509Certificate>): List<X509CRL> {
+            val factory = CertificateFactory.getInstance("X.509")
+            return crls.flatMap { bytes ->
+                try {
+                    factory.generateCRLs(ByteArrayInputStream(bytes)).map { it as X509CRL }
+                } catch (e: CRLException) {
+                    throw C2PAError.Api("Invalid CRL: ${e.message}")
+                }
+            }.onEach { verifySignature(it, trustedIssuers) }
+        }
+
+        private fun verifySignature(crl: X509CRL, trustedIssuers: List<X509Certificate>) {
+            val signed = trustedIssuers.filter { it.subjectX500Principal == crl.issuerX500Principal }.any { issuer ->
+                try {
+                    crl.verify(issuer.publicKey)
+                    true
+                } catch (e: GeneralSecurityException) {
+                    false
+                }
+            }
+            if (!signed) throw C2PAError.Api("CRL from ${crl.issuerX500Principal.name} is not signed by a trusted issuer")
+        }
+
+        private fun isDelta(crl: X509CRL): Boolean = crl.getExtensionValue(DELTA_CRL_INDICATOR) != null
+
+        /**
+         * Adds the entries of [crl] to [issuers], dropping those marked removeFromCRL. Replacing
+         * what was known for an issuer is up to the caller, once per batch, so that several full
+         * CRLs from one issuer (partitions) add up rather than each resetting the last.
+         */
+        private fun merge(issuers: MutableMap<ByteBuffer, IssuerEntries>, crl: X509CRL) {
+            val nextUpdate = crl.nextUpdate?.time ?: Long.MAX_VALUE
+            val crlIssuer = ByteBuffer.wrap(issuerKey(crl.issuerX500Principal))
+            val existing = issuers[crlIssuer]
+            if (existing == null) {
+                issuers[crlIssuer] = IssuerEntries(nextUpdate)
+            } else {
+                existing.nextUpdate = maxOf(existing.nextUpdate, nextUpdate)
+            }
+
+            crl.revokedCertificates?.forEach { entry ->
+                val issuer = entry.certificateIssuer?.let { ByteBuffer.wrap(issuerKey(it)) } ?: crlIssuer
+                val entries = issuers.getOrPut(issuer) { IssuerEntries(nextUpdate) }
+                val serial = ByteBuffer.wrap(entry.serialNumber.toByteArray())
+                if (entry.revocationReason == CRLReason.REMOVE_FROM_CRL) {
+                    entries.serials.remove(serial)
+                } else {
+                    entries.serials.add(serial)
+                }
+            }
+        }
+
+        private fun write(issuers: Map<ByteBuffer, IssuerEntries>, output: File) {
+            val keys = issuers.keys.sortedWith(UNSIGNED_BUFFER_ORDER)
+            val totalSerials = issuers.values.sumOf { it.serials.size }
+            var bloomBits = 64L
+            while (bloomBits < totalSerials.toLong() * BLOOM_BITS_PER_ENTRY) bloomBits *= 2
+            val bloom = LongArray((bloomBits / 64).toInt())
+
+            val widths = keys.map { key -> issuers.getValue(key).serials.maxOfOrNull { it.remaining() } ?: 0 }
+            var serialsOffset = HEADER_SIZE.toLong() + keys.size * ISSUER_ENTRY_SIZE + bloom.size * 8L
+
+            val temp = File.createTempFile(output.name, ".tmp", output.absoluteFile.parentFile)
+            try {
+                DataOutputStream(temp.outputStream().buffered()).use { out ->
+                    out.write(MAGIC)
+                    out.writeInt(VERSION)
+                    out.writeInt(keys.size)
+                    out.writeInt(bloom.size)
+                    out.writeInt(BLOOM_HASHES)
+
+                    val sortedSerials = keys.mapIndexed { i, key ->
+                        val entries = issuers.getValue(key)
+                        out.write(key.array())
+                        out.writeLong(serialsOffset)
+                        out.writeInt(entries.serials.size)
+                        out.writeInt(widths[i])
+                        out.writeLong(entries.nextUpdate)
+                        serialsOffset += entries.serials.size.toLong() * widths[i]
+
+                        val seed = ByteBuffer.wrap(key.array()).getLong(0)
+                        entries.serials.forEach { addToBloom(bloom, seed, it.array()) }
+                        entries.serials.map { pad(it.array(), widths[i]) }.sortedWith(UNSIGNED_ORDER)
+                    }
+
+                    bloom.forEach { out.writeLong(it) }
+                    sortedSerials.forEach { serials -> serials.forEach { out.write(it) } }
+                }
+                Files.move(temp.toPath(), output.toPath(), StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE)
+            } finally {
+                temp.delete()
+            }
+        }
+
+        /** SHA-256 of the DER-encoded issuer name. */
+        private fun issuerKey(issuer: X500Principal): ByteArray =
+            MessageDigest.getInstance("SHA-256").digest(issuer.encoded)
+
+        /** Sign-extends a two's-complement serial to [width] bytes, so fixed-width entries compare by equality. */
+        private fun pad(serial: ByteArray, width: Int): ByteArray {
+            if (serial.size == width) return serial
+            val padded = ByteArray(width)
+            if (serial.isNotEmpty() && serial[0] < 0) padded.fill(0xFF.toByte(), 0, width - serial.size)
+            System.arraycopy(serial, 0, padded, width - serial.size, serial.size)
+            return padded
+        }
+
+        private val UNSIGNED_ORDER = Comparator<ByteArray> { a, b ->
+            for (i in 0 until minOf(a.size, b.size)) {
+                val diff = (a[i].toInt() and 0xFF) - (b[i].toInt() and 0xFF)
+                if (diff != 0) return@Comparator diff
+            }
+            a.size - b.size
+        }
+
+        private val UNSIGNED_BUFFER_ORDER = Comparator<ByteBuffer> { a, b -> UNSIGNED_ORDER.compare(a.array(), b.array()) }
+
+        private fun addToBloom(bloom: LongArray, seed: Long, serial: ByteArray) {
+            val mask = bloom.size.toLong() * 64 - 1
+            val h1 = hash(seed, serial)
+            val h2 = mix(h1) or 1
+            for (i in 0 until BLOOM_HASHES) {
+                val bit = (h1 + i * h2) and mask
+                bloom[(bit ushr 6).toInt()] = bloom[(bit ushr 6).toInt()] or (1L shl (bit and 63).toInt())
+            }
+        }
+
+        /** FNV-1a over the serial, seeded with the issuer key, then finalized. */
+        private fun hash(seed: Long, serial: ByteArray): Long {
+            var h = seed xor -0x340d631b7bdddcdbL
+            for (b in serial) {
+                h = (h xor (b.toLong() and 0xFF)) * 0x100000001b3L
+            }
+            return mix(h)
+        }
+
+        // SplitMix64 finalizer
+        private fun mix(value: Long): Long {
+            var z = value
+            z = (z xor (z ushr 30)) * -0x40a7b892e31b1a47L
+            z = (z xor (z ushr 27)) * -0x6b2fb644ecceee15L
+            return z xor (z ushr 31)
+        }
+    }
+
+    /** Total number of revoked serial numbers in the index. */
+    val revokedCount: Long
+        get() = (0 until issuerCount).sumOf { buffer.getInt(issuerEntry(it) + KEY_SIZE + 8).toLong() }
+
+    /**
+     * Returns whether any issuer's CRL was due to be replaced before [now], in milliseconds
+     * since the epoch. A stale index still answers lookups; refresh it with [applyDelta].
+     */
+    @JvmOverloads
+    fun isStale(now: Long = System.currentTimeMillis()): Boolean =
+        (0 until issuerCount).any { buffer.getLong(issuerEntry(it) + KEY_SIZE + 16) < now }
+
+    /** Returns the status of the certificate with [serial] issued by [issuer]. */
+    fun status(issuer: X500Principal, serial: BigInteger): RevocationStatus {
+        val key = issuerKey(issuer)
+        val entry = findIssuer(key)
+        if (entry < 0) return RevocationStatus.UNKNOWN
+
+        val bytes = serial.toByteArray()
+        if (!mightContain(ByteBuffer.wrap(key).getLong(0), bytes)) return RevocationStatus.GOOD
+
+        val offset = buffer.getLong(entry + KEY_SIZE)
+        val count = buffer.getInt(entry + KEY_SIZE + 8)
+        val width = buffer.getInt(entry + KEY_SIZE + 12)
+        if (bytes.size > width) return RevocationStatus.GOOD
+        val padded = pad(bytes, width)
+
+        var low = 0
+        var high = count - 1
+        while (low <= high) {
+            val mid = (low + high) ushr 1
+            val cmp = compareAt(offset + mid.toLong() * width, padded)
+            when {
+                cmp < 0 -> low = mid + 1
+                cmp > 0 -> high = mid - 1
+                else -> return RevocationStatus.REVOKED
+            }
+        }
+        return RevocationStatus.GOOD
+    }
+
+    /** Returns the status of [certificate]. */
+    fun status(certificate: X509Certificate): RevocationStatus =
+        status(certificate.issuerX500Principal, certificate.serialNumber)
+
+    /**
+     * Checks a signing certificate chain, leaf first. The chain is REVOKED if any certificate
+     * in it is revoked, and UNKNOWN if the index has no CRL for the leaf's issuer. Certificates
+     * other than the leaf are checked when the index covers their issuer.
+     */
+    fun check(chain: List<X509Certificate>): RevocationCheck {
+        if (chain.isEmpty()) return RevocationCheck(RevocationStatus.UNKNOWN)
+        val statuses = chain.map { status(it) }
+        statuses.indexOf(RevocationStatus.REVOKED).takeIf { it >= 0 }?.let {
+            return RevocationCheck(RevocationStatus.REVOKED, chain[it].subjectX500Principal.name)
+        }
+        if (statuses[0] == RevocationStatus.UNKNOWN) {
+            return RevocationCheck(RevocationStatus.UNKNOWN, chain[0].subjectX500Principal.name)
+        }
+        return RevocationCheck(RevocationStatus.GOOD)
+    }
+
+    /**
+     * Applies [crls] to this index and writes the result to [output], which may be this
+     * index's own file. Delta CRLs add entries and remove those marked removeFromCRL. Full CRLs
+     * replace everything known for their issuer; several full CRLs from one issuer in [crls]
+     * (partitions) are combined. This index stays usable; open the returned
+     * index for the update.
+     *
+     * @param crls The delta or full CRLs to apply
+     * @param trustedIssuers Certificates allowed to sign [crls], as for [compile]
+     * @param output The index file to write
+     * @throws C2PAError.Api if a CRL cannot be parsed or is not signed by a trusted issuer
+     * @throws IOException if the index cannot be written
+     */
+    @JvmOverloads
+    @Throws(C2PAError::class, IOException::class)
+    fun applyDelta(crls: List<ByteArray>, trustedIssuers: List<X509Certificate>, output: File = file): RevocationIndex {
+        val parsed = parseCrls(crls, trustedIssuers)
+        val issuers = HashMap<ByteBuffer, IssuerEntries>()
+        for (i in 0 until issuerCount) {
+            val entry = issuerEntry(i)
+            val key = ByteArray(KEY_SIZE).also { readBytes(entry.toLong(), it) }
+            val offset = buffer.getLong(entry + KEY_SIZE)
+            val count = buffer.getInt(entry + KEY_SIZE + 8)
+            val width = buffer.getInt(entry + KEY_SIZE + 12)
+            val entries = IssuerEntries(buffer.getLong(entry + KEY_SIZE + 16))
+            repeat(count) { n ->
+                val padded = ByteArray(width).also { readBytes(offset + n.toLong() * width, it) }
+                entries.serials.add(ByteBuffer.wrap(BigInteger(padded).toByteArray()))
+            }
+            issuers[ByteBuffer.wrap(key)] = entries
+        }
+        // Full CRLs replace what is known for their issuer: clear each such issuer once, then
+        // merge the whole batch, so partitioned full CRLs from one issuer all count
+        parsed.filterNot { isDelta(it) }.forEach { issuers.remove(ByteBuffer.wrap(issuerKey(it.issuerX500Principal))) }
+        parsed.forEach { merge(issuers, it) }
+        write(issuers, output)
+        return open(output)
+    }
+
+    private fun issuerEntry(index: Int): Int = HEADER_SIZE + index * ISSUER_ENTRY_SIZE
+
+    private fun findIssuer(key: ByteArray): Int {
+        var low = 0
+        var high = issuerCount - 1
+        while (low <= high) {
+            val mid = (low + high) ushr 1
+            val entry = issuerEntry(mid)
+            val cmp = compareAt(entry.toLong(), key)
+            when {
+                cmp < 0 -> low = mid + 1
+                cmp > 0 -> high = mid - 1
+                else -> return entry
+            }
+        }
+        return -1
+    }
+
+    private fun mightContain(seed: Long, serial: ByteArray): Boolean {
+        val h1 = hash(seed, serial)
+        val h2 = mix(h1) or 1
+        for (i in 0 until bloomHashes) {
+            val bit = (h1 + i * h2) and bloomMask
+            val word = buffer.getLong(bloomOffset + (bit ushr 6).toInt() * 8)
+            if (word and (1L shl (bit and 63).toInt()) == 0L) return false
+        }
+        return true
+    }
+
+    /** Compares the bytes at [offset] in the index with [bytes], unsigned. */
+    private fun compareAt(offset: Long, bytes: ByteArray): Int {
+        val start = offset.toInt()
+        for (i in bytes.indices) {
+            val diff = (buffer.get(start + i).toInt() and 0xFF) - (bytes[i].toInt() and 0xFF)
+            if (diff != 0) return diff
+        }
+        return 0
+    }
+
+    private fun readBytes(offset: Long, into: ByteArray) {
+        val start = offset.toInt()
+        for (i in into.indices) into[i] = buffer.get(start + i)
+    }
+}
@@ -0,0 +1,218 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import org.contentauth.c2pa.settings.C2PASettingsDefinition
+import java.io.Closeable
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * A live, versioned [C2PAContext] that can be shared by many workers and updated in place.
+ *
+ * Settings are compiled into a native context once per version. Workers obtain readers and
+ * builders from the current version without any parsing, and a settings change (for example a
+ * trust-list or TSA URL update) compiles a new version and swaps it in atomically. Operations
+ * that already hold a snapshot keep using it; operations started after the swap see the new
+ * version. A superseded context is freed once the last operation using it has finished.
+ *
+ * ## Usage
+ *
+ * ```kotlin
+ * val shared = SharedC2PAContext.create(settingsDefinition)
+ *
+ * // Worker threads
+ * shared.newBuilder().withDefinition(manifestJson).use { builder -> ... }
+ *
+ * // Configuration change, applied as one batch
+ * shared.update(mapOf("verify.verify_trust" to "true"))
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * All methods are thread-safe. Reads are lock-free; updates are serialized.
+ *
+ * @see C2PAContext
+ * @see C2PASettings.setValues
+ */
+class SharedC2PAContext private constructor(
+    private var baseSettings: String?,
+    private var baseFormat: String,
+    initial: C2PAContext,
+) : Closeable {
+
+    /** A compiled context shared by every operation started while it was current. */
+    private class Snapshot(val version: Long, val context: C2PAContext) {
+        // One reference is held by the owner for as long as the snapshot is current
+        private val refs = AtomicInteger(1)
+
+        fun retain(): Boolean {
+            while (true) {
+                val count = refs.get()
+                if (count == 0) return false
+                if (refs.compareAndSet(count, count + 1)) return true
+            }
+        }
+
+        fun release() {
+            if (refs.decrementAndGet() == 0) {
+                context.close()
+            }
+        }
+    }
+
+    private val updateLock = Any()
+    private var overrides: Map<String, String> = emptyMap()
+    private val current = AtomicReference<Snapshot?>(Snapshot(1, initial))
+
+    companion object {
+        /**
+         * Creates a shared context from a typed settings definition, or with default settings
+         * when [definition] is null.
+         *
+         * @throws C2PAError.Api if the settings are invalid
+         */
+        @JvmStatic
+        @JvmOverloads
+        @Throws(C2PAError::class)
+        fun create(definition: C2PASettingsDefinition? = null): SharedC2PAContext {
+            val base = definition?.toJson()
+            return SharedC2PAContext(base, "json", compile(base, "json", emptyMap()))
+        }
+
+        /**
+         * Creates a shared context from a settings JSON string.
+         *
+         * @throws C2PAError.Api if the settings are invalid
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        fun fromJson(settingsJson: String): SharedC2PAContext =
+            SharedC2PAContext(settingsJson, "json", compile(settingsJson, "json", emptyMap()))
+
+        private fun compile(base: String?, format: String, overrides: Map<String, String>): C2PAContext =
+            C2PASettings.create().use { settings ->
+                base?.let { settings.updateFromString(it, format) }
+                settings.setValues(overrides)
+                C2PAContext.fromSettings(settings)
+            }
+    }
+
+    /** The version of the current settings. Starts at 1 and increases with every update. */
+    val version: Long
+        get() = current.get()?.version ?: throw IllegalStateException("SharedC2PAContext is closed")
+
+    /**
+     * Runs [block] with the current context, keeping that version alive until [block] returns
+     * even if an update swaps in a newer one meanwhile.
+     *
+     * Readers and builders created inside [block] remain valid after it returns.
+     *
+     * @throws IllegalStateException if this shared context has been closed
+     */
+    fun <T> withCurrentContext(block: (C2PAContext) -> T): T {
+        val snapshot = acquire()
+        try {
+            return block(snapshot.context)
+        } finally {
+            snapshot.release()
+        }
+    }
+
+    /**
+     * Creates a builder from the current settings version.
+     *
+     * @throws C2PAError.Api if the builder cannot be created
+     */
+    @Throws(C2PAError::class)
+    fun newBuilder(): Builder = withCurrentContext { Builder.fromContext(it) }
+
+    /**
+     * Creates a reader from the current settings version.
+     *
+     * @throws C2PAError.Api if the reader cannot be created
+     */
+    @Throws(C2PAError::class)
+    fun newReader(): Reader = withCurrentContext { Reader.fromContext(it) }
+
+    /**
+     * Applies a batch of setting values on top of the current settings and swaps in the result.
+     *
+     * The batch is all-or-nothing: if any value is rejected the current version stays live.
+     *
+     * @param values Map of dot-separated paths to JSON values, as for [C2PASettings.setValue]
+     * @return The new settings version
+     * @throws C2PAError.Api if any value is invalid
+     */
+    @Throws(C2PAError::class)
+    fun update(values: Map<String, String>): Long = synchronized(updateLock) {
+        val merged = LinkedHashMap(overrides).apply { putAll(values) }
+        val version = swap(compile(baseSettings, baseFormat, merged))
+        overrides = merged
+        version
+    }
+
+    /**
+     * Replaces the settings entirely with [definition], discarding earlier [update] values.
+     *
+     * @return The new settings version
+     * @throws C2PAError.Api if the settings are invalid
+     */
+    @Throws(C2PAError::class)
+    fun replace(definition: C2PASettingsDefinition): Long = replace(definition.toJson(), "json")
+
+    /**
+     * Replaces the settings entirely with a JSON or TOML [settings] string, discarding earlier
+     * [update] values.
+     *
+     * @return The new settings version
+     * @throws C2PAError.Api if the settings are invalid
+     */
+    @Throws(C2PAError::class)
+    fun replace(settings: String, format: String): Long = synchronized(updateLock) {
+        val version = swap(compile(settings, format, emptyMap()))
+        baseSettings = settings
+        baseFormat = format
+        overrides = emptyMap()
+        version
+    }
+
+    private fun acquire(): Snapshot {
+        while (true) {
+            val snapshot = current.get() ?: throw IllegalStateException("SharedC2PAContext is closed")
+            // A failed retain means the snapshot was retired after we read it; read again
+            if (snapshot.retain()) return snapshot
+        }
+    }
+
+    private fun swap(context: C2PAContext): Long {
+        val previous = current.get()
+        if (previous == null) {
+            context.close()
+            throw IllegalStateException("SharedC2PAContext is closed")
+        }
+        val next = Snapshot(previous.version + 1, context)
+        current.set(next)
+        previous.release()
+        return next.version
+    }
+
+    /**
+     * Releases the current context. Operations still holding a snapshot finish normally.
+     */
+    override fun close() {
+        synchronized(updateLock) {
+            current.getAndSet(null)?.release()
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonElement
+import kotlinx.serialization.json.JsonObject
+import java.nio.ByteBuffer
+import java.security.MessageDigest
+
+/**
+ * Bounded memo of claim signature checks, shared across readers.
+ *
+ * Renditions and derivatives of one asset carry identical ingredient manifests, so the same claim
+ * signature is otherwise verified again for every asset read. Entries are keyed by the SHA-256 of
+ * the trust settings of the context the check was made for, of the signed COSE structure (the
+ * claim and protected header), of the signature, and of the signing certificate, so a hit is only
+ * possible for byte-identical inputs under the same trust configuration. One cache may be shared
+ * by contexts with different trust settings, and need not be cleared when they change. A hit
+ * skips certificate parsing and the public-key operation. The least recently used entry is
+ * dropped once [maxEntries] is reached.
+ *
+ * Each [C2PAContext] owns one, as [C2PAContext.signatureCache]. Readers created with
+ * [Reader.fromStream] and a [VerificationLevel] below FULL use the process-default context's cache
+ * unless given another context.
+ *
+ * Only the Kotlin signature-only checks go through this cache. Readers at
+ * [VerificationLevel.FULL], and [Reader.upgrade] to FULL, validate in the native library and
+ * bypass it entirely, so it does not speed up full reads.
+ *
+ * @param maxEntries Maximum number of results kept
+ */
+class SignatureVerificationCache @JvmOverloads constructor(val maxEntries: Int = 1024) {
+
+    /**
+     * Cache activity.
+     *
+     * @property hits Checks answered from the cache
+     * @property misses Checks that required verification
+     * @property size Results currently cached
+     */
+    data class Stats(val hits: Long, val misses: Long, val size: Int)
+
+    private val entries = object : LinkedHashMap<ByteBuffer, ClaimIntegrityCheck>(16, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<ByteBuffer, ClaimIntegrityCheck>): Boolean =
+            size > maxEntries
+    }
+
+    private var hits = 0L
+    private var misses = 0L
+
+    init {
+        require(maxEntries > 0) { "maxEntries must be positive" }
+    }
+
+    /** Returns cumulative counters. */
+    @Synchronized
+    fun stats(): Stats = Stats(hits, misses, entries.size)
+
+    /** Drops every cached result, for example to release memory. */
+    @Synchronized
+    fun clear() {
+        entries.clear()
+    }
+
+    /**
+     * Returns the cached result for these inputs, or runs [verify] and caches its result.
+     * Verification runs outside the lock, so concurrent misses for one key may both verify.
+     */
+    internal fun getOrVerify(
+        trust: ByteArray,
+        toBeSigned: ByteArray,
+        signature: ByteArray,
+        certificate: ByteArray,
+        verify: () -> ClaimIntegrityCheck,
+    ): ClaimIntegrityCheck {
+        val key = key(trust, toBeSigned, signature, certificate)
+        synchronized(this) {
+            entries[key]?.let {
+                hits++
+                return it
+            }
+            misses++
+        }
+        val result = verify()
+        synchronized(this) { entries[key] = result }
+        return result
+    }
+
+    private fun key(trust: ByteArray, toBeSigned: ByteArray, signature: ByteArray, certificate: ByteArray): ByteBuffer {
+        val digest = MessageDigest.getInstance("SHA-256")
+        val key = ByteArray(digest.digestLength * 4)
+        listOf(trust, toBeSigned, signature, certificate).forEachIndexed { index, part ->
+            digest.update(part)
+            digest.digest(key, index * digest.digestLength, digest.digestLength)
+        }
+        return ByteBuffer.wrap(key)
+    }
+
+    /** A cache together with the trust settings its results are keyed under. */
+    internal class Scope(val cache: SignatureVerificationCache, val trust: ByteArray)
+
+    internal companion object {
+        /** Canonical form of [trustSettings] for keys; JSON object keys are sorted first. */
+        fun trustKey(trustSettings: JsonObject): ByteArray =
+            sorted(trustSettings).toString().toByteArray(Charsets.UTF_8)
+
+        private fun sorted(element: JsonElement): JsonElement =
+            when (element) {
+                is JsonObject -> JsonObject(element.toSortedMap().mapValues { sorted(it.value) })
+                is JsonArray -> JsonArray(element.map { sorted(it) })
+                else -> element
+            }
+    }
+}
@@ -12,7 +12,11 @@ each license.
 
 package org.contentauth.c2pa
 
+import kotlinx.serialization.json.JsonNull
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
 import java.io.Closeable
+import kotlin.concurrent.write
 
 /** Callback interface for custom signing operations */
 interface SignCallback {
@@ -80,6 +84,9 @@ class Signer internal constructor(internal var ptr: Long) : Closeable {
          * for loading signer configuration from external sources, configuration files, or for CAWG
          * (Creator Assertions Working Group) signers.
          *
+         * As before, [settingsJson] is also loaded as the process-wide settings, exactly as by
+         * [C2PA.loadSettings]. To create a signer without changing them, use [fromContext].
+         *
          * @param settingsJson A JSON string containing signer configuration.
          * @return A new [Signer] instance configured according to the settings.
          * @throws C2PAError if the settings are invalid or the signer cannot be created.
@@ -159,9 +166,59 @@ class Signer internal constructor(internal var ptr: Long) : Closeable {
         fun fromSettingsToml(settingsToml: String): Signer =
             fromSettings(settingsToml, "toml")
 
+        /**
+         * Creates a signer from the signer settings of a [C2PAContext].
+         *
+         * The signer is built by the native settings-based signer from the `signer` and
+         * `cawg_x509_signer` sections of the JSON settings the context was created from. The C
+         * API reads those sections from the process-wide native settings, so they are loaded
+         * there under the settings write lock; the process-default context behind
+         * [Reader.fromStream] is left unchanged, and the signer sections are the only
+         * process-wide settings touched.
+         *
+         * @param context The context whose signer settings to use
+         * @return A configured [Signer] instance
+         * @throws C2PAError.Api if the context has no signer settings or the signer cannot be
+         * created
+         *
+         * @sample
+         * ```kotlin
+         * val settings = C2PASettings.create().updateFromString(tenantSettingsJson, "json")
+         * val context = C2PAContext.fromSettings(settings)
+         * Signer.fromContext(context).use { signer ->
+         *     Builder.fromContext(context).withDefinition(manifestJson).use { builder ->
+         *         builder.sign("image/jpeg", source, dest, signer)
+         *     }
+         * }
+         * ```
+         */
+        @JvmStatic
+        @Throws(C2PAError::class)
+        fun fromContext(context: C2PAContext): Signer {
+            val sections = context.signerSections
+            if ("signer" !in sections) throw C2PAError.Api("Context has no signer settings")
+            // Clear a CAWG signer left in the native settings by an earlier load
+            val cawg = sections["cawg_x509_signer"] ?: JsonNull
+            val settings = JsonObject(
+                mapOf("version" to JsonPrimitive(1)) + sections + ("cawg_x509_signer" to cawg),
+            ).toString()
+            return executeC2PAOperation("Failed to create signer from context") {
+                C2PA.globalSettingsLock.write {
+                    if (C2PA.loadNativeSettings(settings, "json") != 0) {
+                        throw C2PAError.Api(C2PA.getError() ?: "Failed to load signer settings")
+                    }
+                    val handle = nativeFromSettings()
+                    if (handle == 0L) null else Signer(handle)
+                }
+            }
+        }
+
         /**
          * Creates a signer from settings configuration in the specified format.
          *
+         * The settings are loaded as the process-wide settings, as by [C2PA.loadSettings], and
+         * the native settings-based signer is created from them under the settings write lock.
+         *
          * @param settings The settings string in the specified format.
          * @param format The format of the settings string ("json" or "toml").
          * @return A new [Signer] instance configured according to the settings.
@@ -171,19 +228,23 @@ class Signer internal constructor(internal var ptr: Long) : Closeable {
         @Throws(C2PAError::class)
         private fun fromSettings(settings: String, format: String): Signer =
             executeC2PAOperation("Failed to create signer from settings") {
-                val loadResult = C2PA.loadSettingsResult(settings, format)
-                if (loadResult != 0) {
-                    throw C2PAError.Api(C2PA.getError() ?: "Failed to load settings")
+                C2PA.globalSettingsLock.write {
+                    val loadResult = C2PA.loadSettingsResult(settings, format)
+                    if (loadResult != 0) {
+                        throw C2PAError.Api(C2PA.getError() ?: "Failed to load settings")
+                    }
+                    val handle = nativeFromSettings()
+                    if (handle == 0L) null else Signer(handle)
                 }
-                val handle = nativeFromSettings()
-                if (handle == 0L) null else Signer(handle)
             }
 
         /**
-         * Loads global C2PA settings without creating a signer.
+         * Loads C2PA settings without creating a signer.
          *
-         * This method loads settings that will be used by subsequent signing operations. Use this
-         * to load CAWG identity assertion settings separately from the main signer.
+         * The settings become the process-default context used by [C2PA.readFile] and
+         * [Reader.fromStream], and are also loaded for the native settings-based signer used for
+         * CAWG identity assertions. Prefer [C2PAContext] and [fromContext] when different
+         * operations need different settings.
          *
          * @param settings The settings string in the specified format.
          * @param format The format of the settings string ("json" or "toml").
@@ -257,6 +318,22 @@ class Signer internal constructor(internal var ptr: Long) : Closeable {
         private external fun nativeFromSettings(): Long
     }
 
+    /**
+     * Sizes of the signatures this signer has produced. Once the tracker is in use (after the
+     * first [adaptiveReserveSize] call), [Builder] records each signature made with this signer
+     * here.
+     */
+    val reserveTracker: ReserveSizeTracker = ReserveSizeTracker({ reserveSize() })
+
+    /**
+     * Returns a reserve size for [Builder.dataHashedPlaceholder] based on the signatures this
+     * signer has produced, falling back to [reserveSize] until one has been observed.
+     *
+     * @see ReserveSizeTracker
+     */
+    @Throws(C2PAError::class)
+    fun adaptiveReserveSize(): Int = reserveTracker.reserveSize()
+
     /** Get the reserve size for this signer */
     @Throws(C2PAError::class)
     fun reserveSize(): Int {
@@ -0,0 +1,188 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+import java.io.Closeable
+import java.util.concurrent.LinkedBlockingQueue
+import java.util.concurrent.Semaphore
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Spreads signing work over several single-threaded signing backends.
+ *
+ * Backends such as a KeyStore [java.security.Signature], an HSM session or a web client are
+ * often not safe to use from several threads at once. A pool owns N such backends and hands each
+ * sign request to a free one, so concurrent [Builder.sign] calls scale with the number of
+ * backends instead of serializing on one. When every backend is busy, up to [maxQueued] requests
+ * wait for one to become free; further requests are rejected immediately so callers can shed
+ * load instead of piling up behind a slow backend.
+ *
+ * ```kotlin
+ * val pool = SignerPool.create(size = hsmSessions.size) { index -> hsmSessions[index]::sign }
+ * pool.createSigner(SigningAlgorithm.ES256, certificateChainPEM).use { signer ->
+ *     builder.sign("image/jpeg", source, dest, signer)
+ * }
+ * ```
+ *
+ * @param backends The signing backends; each is only ever used by one thread at a time
+ * @param maxQueued Number of requests allowed to wait for a free backend
+ * @param acquireTimeoutMillis How long a queued request waits for a backend before failing
+ */
+class SignerPool(
+    backends: List<(ByteArray) -> ByteArray>,
+    val maxQueued: Int = backends.size * 4,
+    private val acquireTimeoutMillis: Long = 30_000,
+) : Closeable {
+
+    /**
+     * A snapshot of pool activity.
+     *
+     * @property size Number of backends
+     * @property busy Backends currently signing
+     * @property queued Requests waiting for a backend
+     * @property completed Requests that returned a signature
+     * @property failed Requests whose backend threw
+     * @property rejected Requests refused because the queue was full or the wait timed out
+     * @property averageWaitMillis Mean time requests spent waiting for a backend
+     * @property averageSignMillis Mean time backends spent signing
+     */
+    data class Stats(
+        val size: Int,
+        val busy: Int,
+        val queued: Int,
+        val completed: Long,
+        val failed: Long,
+        val rejected: Long,
+        val averageWaitMillis: Double,
+        val averageSignMillis: Double,
+    ) {
+        /** Fraction of backends currently signing. */
+        val utilization: Double get() = if (size == 0) 0.0 else busy.toDouble() / size
+    }
+
+    private val idle = LinkedBlockingQueue(backends)
+    private val size = backends.size
+    private val admission = Semaphore(backends.size + maxQueued)
+
+    private val busy = AtomicInteger()
+    private val queued = AtomicInteger()
+    private val completed = AtomicLong()
+    private val failed = AtomicLong()
+    private val rejected = AtomicLong()
+    private val waitNanos = AtomicLong()
+    private val signNanos = AtomicLong()
+
+    @Volatile
+    private var closed = false
+
+    init {
+        require(backends.isNotEmpty()) { "SignerPool needs at least one backend" }
+        require(maxQueued >= 0) { "maxQueued must not be negative" }
+    }
+
+    companion object {
+        /**
+         * Creates a pool of [size] backends built by [factory], which receives the backend index.
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun create(
+            size: Int,
+            maxQueued: Int = size * 4,
+            factory: (Int) -> (ByteArray) -> ByteArray,
+        ): SignerPool = SignerPool(List(size, factory), maxQueued)
+    }
+
+    /**
+     * Signs [data] on the next free backend.
+     *
+     * @throws C2PAError.Api if the pool is closed, the queue is full, or no backend became free
+     * within the acquire timeout
+     */
+    @Throws(C2PAError::class)
+    fun sign(data: ByteArray): ByteArray {
+        if (closed) throw C2PAError.Api("SignerPool is closed")
+        if (!admission.tryAcquire()) {
+            rejected.incrementAndGet()
+            throw C2PAError.Api("SignerPool saturated: $size busy, $maxQueued queued")
+        }
+        try {
+            val backend = takeBackend()
+            busy.incrementAndGet()
+            val start = System.nanoTime()
+            try {
+                return backend(data).also { completed.incrementAndGet() }
+            } catch (e: Exception) {
+                failed.incrementAndGet()
+                throw e
+            } finally {
+                signNanos.addAndGet(System.nanoTime() - start)
+                busy.decrementAndGet()
+                idle.put(backend)
+            }
+        } finally {
+            admission.release()
+        }
+    }
+
+    private fun takeBackend(): (ByteArray) -> ByteArray {
+        idle.poll()?.let { return it }
+        queued.incrementAndGet()
+        val start = System.nanoTime()
+        try {
+            return idle.poll(acquireTimeoutMillis, TimeUnit.MILLISECONDS) ?: run {
+                rejected.incrementAndGet()
+                throw C2PAError.Api("Timed out waiting for a free signing backend")
+            }
+        } finally {
+            waitNanos.addAndGet(System.nanoTime() - start)
+            queued.decrementAndGet()
+        }
+    }
+
+    /**
+     * Creates a [Signer] whose signatures are produced by this pool. Any number of signers may
+     * share one pool.
+     *
+     * @param algorithm The signing algorithm the backends implement
+     * @param certificateChainPEM The certificate chain in PEM format
+     * @param tsaURL Optional timestamp authority URL
+     * @throws C2PAError.Api if the signer cannot be created
+     */
+    @JvmOverloads
+    @Throws(C2PAError::class)
+    fun createSigner(algorithm: SigningAlgorithm, certificateChainPEM: String, tsaURL: String? = null): Signer =
+        Signer.withCallback(algorithm, certificateChainPEM, tsaURL) { data -> sign(data) }
+
+    /** Returns current utilization and cumulative counters. */
+    fun stats(): Stats {
+        val done = completed.get() + failed.get()
+        return Stats(
+            size = size,
+            busy = busy.get(),
+            queued = queued.get(),
+            completed = completed.get(),
+            failed = failed.get(),
+            rejected = rejected.get(),
+            averageWaitMillis = if (done == 0L) 0.0 else waitNanos.get() / 1e6 / done,
+            averageSignMillis = if (done == 0L) 0.0 else signNanos.get() / 1e6 / done,
+        )
+    }
+
+    /** Stops accepting requests. Requests already running or queued complete normally. */
+    override fun close() {
+        closed = true
+    }
+}
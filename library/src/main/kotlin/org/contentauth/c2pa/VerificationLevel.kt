@@ -0,0 +1,64 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa
+
+/**
+ * How much validation a [Reader] performs when it is created.
+ *
+ * Levels are ordered; [Reader.upgrade] moves a reader to a higher level.
+ */
+enum class VerificationLevel {
+    /**
+     * Parses the manifest store without validating it. The JSON has no validation results.
+     * Suitable for gallery previews and triage.
+     */
+    STRUCTURE_ONLY,
+
+    /**
+     * Parses the manifest store and checks that the active manifest's claim is intact under the
+     * key in its own embedded signing certificate, without hashing the asset. The result is in
+     * [Reader.integrityCheck].
+     *
+     * The native library cannot check a claim signature without also hashing the asset, so this
+     * check is made on the Kotlin side and is not a validation: the certificate chain is not
+     * checked against any trust list, and the reader's JSON carries no validation results at
+     * this level. Treat the result as "unchanged since signing by whoever holds this key", and
+     * use [FULL] before showing whether, or by whom, the asset was validly signed.
+     */
+    SIGNATURE_ONLY,
+
+    /** Full validation: hard-binding hashes over the asset, signatures and certificate chains. */
+    FULL,
+}
+
+/**
+ * Result of the claim check made for [VerificationLevel.SIGNATURE_ONLY].
+ *
+ * This is not a validation result, and readers at [VerificationLevel.FULL] never carry one. The
+ * claim is checked with the leaf certificate embedded in its own signature, whose chain and trust
+ * are not validated, so [intact] only means the claim has not been altered since it was signed
+ * with that certificate's key.
+ *
+ * @property intact Whether the claim signature verifies against the embedded, untrusted leaf
+ * certificate
+ * @property algorithm The COSE algorithm name, such as "ES256", if known
+ * @property claimedSigner The embedded certificate's subject, if it could be read. Not verified:
+ * do not present it as the signer's identity
+ * @property message Why the claim could not be checked, when [intact] is false
+ */
+data class ClaimIntegrityCheck(
+    val intact: Boolean,
+    val algorithm: String? = null,
+    val claimedSigner: String? = null,
+    val message: String? = null,
+)
@@ -14,15 +14,35 @@ package org.contentauth.c2pa
 
 import android.util.Base64
 import kotlinx.serialization.Serializable
+import okhttp3.Call
+import okhttp3.Callback
+import okhttp3.ConnectionPool
+import okhttp3.Dispatcher
 import okhttp3.MediaType.Companion.toMediaType
 import okhttp3.OkHttpClient
 import okhttp3.Request
+import okhttp3.RequestBody
 import okhttp3.RequestBody.Companion.toRequestBody
+import okhttp3.Response
+import java.io.IOException
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.LinkedBlockingQueue
+import java.util.concurrent.ThreadLocalRandom
 import java.util.concurrent.TimeUnit
 
 /**
  * WebServiceSigner provides remote signing capabilities through a C2PA signing server.
  *
+ * Each sign request runs within the latency budget of [policy]. A request that has not completed
+ * after a delay derived from the endpoint's recent p95 latency is hedged: the same claim is sent to
+ * the next endpoint and whichever signature arrives first is used. Failed attempts are retried
+ * with jittered exponential backoff. Both are safe because signing a claim has no side effects on
+ * the server; any signature the server returns is valid for the claim.
+ *
+ * Endpoints are the configured `signing_url` followed by [fallbackSigningURLs]. Their health is
+ * tracked per URL: endpoints that fail repeatedly are tried last until [RequestPolicy.ejectionMillis]
+ * has passed, and healthy endpoints are ordered by p95 latency.
+ *
  * Example usage:
  * ```kotlin
  * val webServiceSigner = WebServiceSigner(
@@ -33,20 +53,93 @@ import java.util.concurrent.TimeUnit
  * val signer = webServiceSigner.createSigner()
  * ```
  */
-class WebServiceSigner(
+class WebServiceSigner @JvmOverloads constructor(
     private val configurationURL: String,
     private val bearerToken: String? = null,
     private val customHeaders: Map<String, String> = emptyMap(),
+    val policy: RequestPolicy = RequestPolicy(),
+    private val fallbackSigningURLs: List<String> = emptyList(),
 ) {
+    /**
+     * Latency budget, retry and hedging settings for sign requests.
+     *
+     * @property attemptTimeoutMillis Time allowed for one HTTP request, from connect to last byte
+     * @property totalBudgetMillis Time allowed for signing one claim, across all attempts and hedges
+     * @property maxAttempts Attempts before giving up; each attempt may include one hedged request
+     * @property backoffBaseMillis Backoff before the first retry; doubled for each further retry
+     * @property backoffMaxMillis Upper bound on the backoff before any retry
+     * @property hedging Whether to send a second request when the first is slow
+     * @property initialHedgeDelayMillis Hedge delay used until an endpoint has enough latency samples
+     * @property minHedgeDelayMillis Lower bound on the p95-based hedge delay
+     * @property ejectionFailures Consecutive failures after which an endpoint is tried last
+     * @property ejectionMillis How long an ejected endpoint is tried last
+     * @property maxConcurrentRequests Sign requests in flight at once, per endpoint and in total.
+     * Requests are dispatched asynchronously, so OkHttp's default of 5 per host would queue the
+     * rest of a batch (and its hedges) behind the first five.
+     */
+    data class RequestPolicy(
+        val attemptTimeoutMillis: Long = 10_000,
+        val totalBudgetMillis: Long = 30_000,
+        val maxAttempts: Int = 3,
+        val backoffBaseMillis: Long = 100,
+        val backoffMaxMillis: Long = 2_000,
+        val hedging: Boolean = true,
+        val initialHedgeDelayMillis: Long = 1_000,
+        val minHedgeDelayMillis: Long = 50,
+        val ejectionFailures: Int = 3,
+        val ejectionMillis: Long = 30_000,
+        val maxConcurrentRequests: Int = 64,
+    ) {
+        init {
+            require(attemptTimeoutMillis > 0) { "attemptTimeoutMillis must be positive" }
+            require(totalBudgetMillis > 0) { "totalBudgetMillis must be positive" }
+            require(maxAttempts > 0) { "maxAttempts must be positive" }
+            require(ejectionFailures > 0) { "ejectionFailures must be positive" }
+            require(maxConcurrentRequests > 0) { "maxConcurrentRequests must be positive" }
+        }
+    }
+
+    /**
+     * Observed health of one signing endpoint.
+     *
+     * @property url The signing URL
+     * @property requests Requests that completed, successfully or not; cancelled hedges are not counted
+     * @property failures Requests that failed
+     * @property hedgesWon Hedged requests to this endpoint that returned first
+     * @property consecutiveFailures Failures since the last success
+     * @property p50Millis Median latency of recent successful requests, or null without samples
+     * @property p95Millis 95th percentile latency of recent successful requests, or null without samples
+     * @property ejected Whether the endpoint is currently tried last
+     */
+    data class EndpointStats(
+        val url: String,
+        val requests: Long,
+        val failures: Long,
+        val hedgesWon: Long,
+        val consecutiveFailures: Int,
+        val p50Millis: Long?,
+        val p95Millis: Long?,
+        val ejected: Boolean,
+    )
+
     private val httpClient =
         OkHttpClient.Builder()
-            .connectTimeout(30, TimeUnit.SECONDS)
-            .readTimeout(30, TimeUnit.SECONDS)
-            .writeTimeout(30, TimeUnit.SECONDS)
+            .connectTimeout(policy.attemptTimeoutMillis, TimeUnit.MILLISECONDS)
+            .readTimeout(policy.attemptTimeoutMillis, TimeUnit.MILLISECONDS)
+            .writeTimeout(policy.attemptTimeoutMillis, TimeUnit.MILLISECONDS)
+            .dispatcher(
+                Dispatcher().apply {
+                    maxRequests = policy.maxConcurrentRequests
+                    maxRequestsPerHost = policy.maxConcurrentRequests
+                },
+            )
+            .connectionPool(ConnectionPool(policy.maxConcurrentRequests, 5, TimeUnit.MINUTES))
             .build()
 
     private var signingURL: String? = null
 
+    private val endpoints = ConcurrentHashMap<String, EndpointHealth>()
+
     /**
      * Creates a Signer instance configured for remote signing. This method fetches the
      * configuration from the server and sets up the signing callback.
@@ -56,12 +149,19 @@ class WebServiceSigner(
         val signingAlgorithm = mapAlgorithm(configuration.algorithm)
         signingURL = configuration.signing_url
         val certificateChain = parseCertificateChain(configuration.certificate_chain)
+        val signingURLs = (listOf(configuration.signing_url) + fallbackSigningURLs).distinct()
 
         return Signer.withCallback(
             algorithm = signingAlgorithm,
             certificateChainPEM = certificateChain,
             tsaURL = configuration.timestamp_url.takeIf { it.isNotEmpty() },
-        ) { data -> signData(data, configuration.signing_url) }
+        ) { data -> signData(data, signingURLs) }
+    }
+
+    /** Returns the health of every endpoint that has been used, healthiest first. */
+    fun endpointStats(): List<EndpointStats> {
+        val now = System.nanoTime()
+        return rank(endpoints.keys.toList(), now).map { endpoints.getValue(it).snapshot(it, now) }
     }
 
     private fun mapAlgorithm(algorithmString: String): SigningAlgorithm = when (algorithmString.lowercase()) {
@@ -94,23 +194,135 @@ class WebServiceSigner(
         return C2PAJson.default.decodeFromString(responseBody)
     }
 
-    private fun signData(data: ByteArray, signingURL: String): ByteArray {
+    private fun signData(data: ByteArray, signingURLs: List<String>): ByteArray {
         val dataToSignBase64 = Base64.encodeToString(data, Base64.NO_WRAP)
         val requestJson =
             C2PAJson.default.encodeToString(SignRequest.serializer(), SignRequest(claim = dataToSignBase64))
+        val body = requestJson.toRequestBody("application/json".toMediaType())
+
+        val deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(policy.totalBudgetMillis)
+        var lastError: Exception? = null
+        var attempts = 0
+        while (attempts < policy.maxAttempts) {
+            if (attempts > 0) {
+                val remaining = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime())
+                if (remaining <= 0) break
+                Thread.sleep(minOf(backoffMillis(attempts), remaining))
+            }
+            if (deadline - System.nanoTime() <= 0) break
+            attempts++
+            try {
+                return attempt(body, signingURLs, deadline)
+            } catch (e: SignerException.HttpError) {
+                if (!isRetryable(e.statusCode)) throw e
+                lastError = e
+            } catch (e: SignerException.InvalidResponse) {
+                lastError = e
+            } catch (e: IOException) {
+                lastError = e
+            }
+        }
+        throw SignerException.RequestFailed(attempts, policy.totalBudgetMillis, lastError)
+    }
+
+    /**
+     * Sends one attempt to the healthiest endpoint, hedging to the next endpoint if the first has
+     * not answered within its hedge delay or fails outright.
+     */
+    private fun attempt(body: RequestBody, signingURLs: List<String>, deadline: Long): ByteArray {
+        val ranked = rank(signingURLs, System.nanoTime())
+        // With a single endpoint the hedge goes to the same URL, which behind a load balancer
+        // usually reaches a different instance
+        val targets = if (policy.hedging) listOf(ranked[0], ranked.getOrElse(1) { ranked[0] }) else listOf(ranked[0])
+        val outcomes = LinkedBlockingQueue<Outcome>()
+        val calls = mutableListOf<Call>()
+
+        fun launch(url: String, hedge: Boolean) {
+            val health = endpoints.computeIfAbsent(url) { EndpointHealth() }
+            val remaining = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime()).coerceAtLeast(1)
+            val call = httpClient.newCall(signRequest(url, body))
+            call.timeout().timeout(minOf(policy.attemptTimeoutMillis, remaining), TimeUnit.MILLISECONDS)
+            calls += call
+            val start = System.nanoTime()
+            call.enqueue(
+                object : Callback {
+                    override fun onResponse(call: Call, response: Response) {
+                        val outcome = try {
+                            response.use { Outcome(url, hedge, signature = parseSignResponse(it)) }
+                        } catch (e: Exception) {
+                            Outcome(url, hedge, error = e)
+                        }
+                        complete(call, outcome)
+                    }
+
+                    override fun onFailure(call: Call, e: IOException) {
+                        complete(call, Outcome(url, hedge, error = e))
+                    }
+
+                    private fun complete(call: Call, outcome: Outcome) {
+                        // A hedge that lost the race says nothing about the endpoint
+                        if (call.isCanceled()) return
+                        val elapsed = System.nanoTime() - start
+                        if (outcome.signature != null) health.recordSuccess(elapsed) else health.recordFailure()
+                        outcomes.put(outcome)
+                    }
+                },
+            )
+        }
+
+        try {
+            launch(targets[0], hedge = false)
+            var launched = 1
+            var failed = 0
+            var lastError: Exception? = null
+            while (true) {
+                val remaining = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime())
+                if (remaining <= 0) {
+                    throw lastError ?: IOException("Latency budget of ${policy.totalBudgetMillis} ms exhausted")
+                }
+                val canHedge = launched < targets.size
+                val wait = if (canHedge) minOf(hedgeDelayMillis(targets[0]), remaining) else remaining
+                val outcome = outcomes.poll(wait, TimeUnit.MILLISECONDS)
+                if (outcome == null) {
+                    if (canHedge) {
+                        launch(targets[launched++], hedge = true)
+                    }
+                    continue
+                }
+                outcome.signature?.let { signature ->
+                    if (outcome.hedge) endpoints[outcome.url]?.recordHedgeWin()
+                    return signature
+                }
+                val error = outcome.error ?: SignerException.InvalidResponse
+                if (error is SignerException.HttpError && !isRetryable(error.statusCode)) throw error
+                lastError = error
+                failed++
+                if (failed == launched) {
+                    if (!canHedge) throw error
+                    // Fail over at once rather than waiting out the hedge delay
+                    launch(targets[launched++], hedge = true)
+                }
+            }
+        } finally {
+            calls.forEach { it.cancel() }
+        }
+    }
 
+    private fun signRequest(url: String, body: RequestBody): Request {
         val requestBuilder =
             Request.Builder()
-                .url(signingURL)
-                .post(requestJson.toRequestBody("application/json".toMediaType()))
+                .url(url)
+                .post(body)
                 .header("Accept", "application/json")
 
         customHeaders.forEach { (key, value) -> requestBuilder.header(key, value) }
 
         bearerToken?.let { requestBuilder.header("Authorization", "Bearer $it") }
 
-        val response = httpClient.newCall(requestBuilder.build()).execute()
+        return requestBuilder.build()
+    }
 
+    private fun parseSignResponse(response: Response): ByteArray {
         if (!response.isSuccessful) {
             val errorBody = response.body?.string()
             throw SignerException.HttpError(response.code, errorBody)
@@ -121,6 +333,107 @@ class WebServiceSigner(
         return Base64.decode(signResponse.signature, Base64.NO_WRAP)
     }
 
+    /** Orders [urls] with endpoints that are not ejected first, then by p95 latency. */
+    private fun rank(urls: List<String>, now: Long): List<String> =
+        urls.sortedWith(
+            compareBy<String>(
+                { endpoints[it]?.isEjected(now) == true },
+                { endpoints[it]?.percentile(0.95) ?: 0L },
+            ),
+        )
+
+    private fun hedgeDelayMillis(url: String): Long {
+        val p95 = endpoints[url]?.percentile(0.95)?.let { TimeUnit.NANOSECONDS.toMillis(it) }
+            ?: return policy.initialHedgeDelayMillis
+        return p95.coerceIn(policy.minHedgeDelayMillis, policy.attemptTimeoutMillis)
+    }
+
+    /** Full jitter: a uniform delay up to the capped exponential backoff for [retry]. */
+    private fun backoffMillis(retry: Int): Long {
+        val cap = minOf(policy.backoffMaxMillis, policy.backoffBaseMillis shl minOf(retry - 1, 20))
+        return if (cap <= 0) 0 else ThreadLocalRandom.current().nextLong(cap + 1)
+    }
+
+    /** Server errors, throttling and timeouts are worth retrying; other client errors are not. */
+    private fun isRetryable(statusCode: Int): Boolean = statusCode >= 500 || statusCode == 408 || statusCode == 429
+
+    private class Outcome(
+        val url: String,
+        val hedge: Boolean,
+        val signature: ByteArray? = null,
+        val error: Exception? = null,
+    )
+
+    /** Latency window and failure counters for one endpoint. */
+    private inner class EndpointHealth {
+        private val latencies = LongArray(LATENCY_WINDOW)
+        private var samples = 0
+        private var next = 0
+        private var requests = 0L
+        private var failures = 0L
+        private var hedgesWon = 0L
+        private var consecutiveFailures = 0
+        private var ejectedUntil = 0L
+
+        @Synchronized
+        fun recordSuccess(elapsedNanos: Long) {
+            latencies[next] = elapsedNanos
+            next = (next + 1) % LATENCY_WINDOW
+            if (samples < LATENCY_WINDOW) samples++
+            requests++
+            consecutiveFailures = 0
+            ejectedUntil = 0
+        }
+
+        @Synchronized
+        fun recordFailure() {
+            requests++
+            failures++
+            consecutiveFailures++
+            if (consecutiveFailures >= policy.ejectionFailures) {
+                ejectedUntil = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(policy.ejectionMillis)
+            }
+        }
+
+        @Synchronized
+        fun recordHedgeWin() {
+            hedgesWon++
+        }
+
+        @Synchronized
+        fun isEjected(now: Long): Boolean = ejectedUntil != 0L && now - ejectedUntil < 0
+
+        /** Returns the [quantile] of recent latencies in nanoseconds, or null with too few samples. */
+        @Synchronized
+        fun percentile(quantile: Double): Long? {
+            if (samples < MIN_LATENCY_SAMPLES) return null
+            val sorted = latencies.copyOf(samples).apply { sort() }
+            return sorted[((samples - 1) * quantile).toInt()]
+        }
+
+        @Synchronized
+        fun snapshot(url: String, now: Long): EndpointStats {
+            val sorted = latencies.copyOf(samples).apply { sort() }
+            fun millisAt(quantile: Double) =
+                if (samples == 0) null else TimeUnit.NANOSECONDS.toMillis(sorted[((samples - 1) * quantile).toInt()])
+            return EndpointStats(
+                url = url,
+                requests = requests,
+                failures = failures,
+                hedgesWon = hedgesWon,
+                consecutiveFailures = consecutiveFailures,
+                p50Millis = millisAt(0.5),
+                p95Millis = millisAt(0.95),
+                ejected = isEjected(now),
+            )
+        }
+    }
+
+    private companion object {
+        const val LATENCY_WINDOW = 128
+        const val MIN_LATENCY_SAMPLES = 10
+    }
+
     private fun parseCertificateChain(base64Chain: String): String {
         val chainData = Base64.decode(base64Chain, Base64.DEFAULT)
         val chainString = String(chainData, Charsets.UTF_8)
@@ -156,4 +469,10 @@ sealed class SignerException(message: String, cause: Throwable? = null) : Except
     object InvalidCertificateChain : SignerException("Invalid certificate chain")
     object NoCertificatesFound : SignerException("No certificates found in chain")
     object InvalidSignature : SignerException("Invalid signature format")
+    class RequestFailed(val attempts: Int, val budgetMillis: Long, cause: Throwable?) :
+        SignerException(
+            "Remote signing failed after $attempts attempt(s) within $budgetMillis ms" +
+                (cause?.message?.let { ": $it" } ?: ""),
+            cause,
+        )
 }
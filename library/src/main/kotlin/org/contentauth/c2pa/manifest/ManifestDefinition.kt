@@ -15,6 +15,7 @@ package org.contentauth.c2pa.manifest
 import kotlinx.serialization.SerialName
 import kotlinx.serialization.Serializable
 import kotlinx.serialization.encodeToString
+import org.contentauth.c2pa.C2PACbor
 import org.contentauth.c2pa.C2PAJson
 
 /**
@@ -142,6 +143,14 @@ data class ManifestDefinition(
      */
     fun toPrettyJson(): String = C2PAJson.pretty.encodeToString(this)
 
+    /**
+     * Converts this manifest definition to CBOR, for storing or transmitting it compactly.
+     * Builders take definitions as JSON; use [toJson] for those.
+     *
+     * @return The manifest encoded as CBOR.
+     */
+    fun toCbor(): ByteArray = C2PACbor.encodeToByteArray(serializer(), this)
+
     override fun toString(): String = toJson()
 
     companion object {
@@ -154,6 +163,15 @@ data class ManifestDefinition(
         fun fromJson(jsonString: String): ManifestDefinition =
             C2PAJson.default.decodeFromString(jsonString)
 
+        /**
+         * Parses a ManifestDefinition from CBOR.
+         *
+         * @param cbor The CBOR bytes to parse.
+         * @return The parsed ManifestDefinition.
+         */
+        fun fromCbor(cbor: ByteArray): ManifestDefinition =
+            C2PACbor.decodeFromByteArray(serializer(), cbor)
+
         /**
          * Creates a minimal manifest definition for a newly created asset.
          *
@@ -0,0 +1,393 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.manifest
+
+import kotlinx.serialization.DeserializationStrategy
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.builtins.serializer
+import kotlinx.serialization.json.JsonPrimitive
+import org.contentauth.c2pa.C2PACbor
+import org.contentauth.c2pa.C2PAJson
+
+/** Location of one encoded value inside a [ManifestIndex] buffer. */
+internal class Span(val start: Int, val end: Int)
+
+/**
+ * Structural index over an encoded manifest store.
+ *
+ * Implementations only skip over values to find their boundaries; nothing is materialized until
+ * [decode] is called for a specific [Span].
+ */
+internal sealed class ManifestIndex {
+
+    /** The span of the whole document. */
+    abstract val root: Span
+
+    /** Returns the key/value spans of the object at [span], or null if it is not an object. */
+    abstract fun entries(span: Span): Map<String, Span>?
+
+    /** Returns the element spans of the array at [span], or null if it is not an array. */
+    abstract fun elements(span: Span): List<Span>?
+
+    /** Returns true if the value at [span] is null. */
+    abstract fun isNull(span: Span): Boolean
+
+    /** Decodes the value at [span] with [deserializer]. */
+    abstract fun <T> decode(deserializer: DeserializationStrategy<T>, span: Span): T
+
+    /** Decodes the value at [span] as a string, or returns null if it is not a string. */
+    fun string(span: Span): String? =
+        if (isString(span)) decode(String.serializer(), span) else null
+
+    protected abstract fun isString(span: Span): Boolean
+
+    protected companion object {
+        // Same nesting limit as C2PACbor
+        const val MAX_DEPTH = 512
+    }
+
+    /**
+     * Index over JSON text. The whole document is checked against the JSON grammar once, when
+     * the index is created, so malformed input is rejected up front; later lookups only skip
+     * over values whose structure is already known to be valid.
+     */
+    class Json(private val text: String) : ManifestIndex() {
+
+        override val root: Span = run {
+            val start = skipWhitespace(0)
+            val end = validateValue(start, 0)
+            var pos = end
+            while (pos < text.length && isWhitespace(text[pos])) pos++
+            if (pos != text.length) throw SerializationException("Unexpected data at offset $pos in manifest JSON")
+            Span(start, end)
+        }
+
+        override fun entries(span: Span): Map<String, Span>? {
+            if (text[span.start] != '{') return null
+            val entries = LinkedHashMap<String, Span>()
+            var pos = skipWhitespace(span.start + 1)
+            while (text[pos] != '}') {
+                val keyEnd = skipString(pos)
+                val key = decodeKey(pos, keyEnd)
+                pos = skipWhitespace(keyEnd)
+                expect(pos++, ':')
+                val valueStart = skipWhitespace(pos)
+                val valueEnd = skipValue(valueStart)
+                entries[key] = Span(valueStart, valueEnd)
+                pos = skipWhitespace(valueEnd)
+                if (text[pos] == ',') pos = skipWhitespace(pos + 1)
+            }
+            return entries
+        }
+
+        override fun elements(span: Span): List<Span>? {
+            if (text[span.start] != '[') return null
+            val elements = ArrayList<Span>()
+            var pos = skipWhitespace(span.start + 1)
+            while (text[pos] != ']') {
+                val end = skipValue(pos)
+                elements.add(Span(pos, end))
+                pos = skipWhitespace(end)
+                if (text[pos] == ',') pos = skipWhitespace(pos + 1)
+            }
+            return elements
+        }
+
+        override fun isNull(span: Span): Boolean = text.startsWith("null", span.start)
+
+        override fun isString(span: Span): Boolean = text[span.start] == '"'
+
+        override fun <T> decode(deserializer: DeserializationStrategy<T>, span: Span): T =
+            C2PAJson.default.decodeFromString(deserializer, text.substring(span.start, span.end))
+
+        private fun decodeKey(start: Int, end: Int): String =
+            if (text.indexOf('\\', start).let { it < 0 || it >= end }) {
+                text.substring(start + 1, end - 1)
+            } else {
+                C2PAJson.default.decodeFromString(String.serializer(), text.substring(start, end))
+            }
+
+        private fun expect(pos: Int, c: Char) {
+            if (pos >= text.length || text[pos] != c) {
+                throw SerializationException("Expected '$c' at offset $pos in manifest JSON")
+            }
+        }
+
+        private fun isWhitespace(c: Char): Boolean = c == ' ' || c == '\n' || c == '\r' || c == '\t'
+
+        private fun skipWhitespace(from: Int): Int {
+            var pos = from
+            while (pos < text.length && isWhitespace(text[pos])) pos++
+            if (pos >= text.length) throw SerializationException("Unexpected end of manifest JSON")
+            return pos
+        }
+
+        /** Skips a string starting at [from], rejecting control characters and invalid escapes. */
+        private fun skipString(from: Int): Int {
+            expect(from, '"')
+            var pos = from + 1
+            while (pos < text.length) {
+                val c = text[pos]
+                when {
+                    c == '"' -> return pos + 1
+                    c == '\\' -> {
+                        val escape = text.getOrNull(pos + 1)
+                        pos += when (escape) {
+                            '"', '\\', '/', 'b', 'f', 'n', 'r', 't' -> 2
+                            'u' -> {
+                                val hex = (pos + 2..pos + 5).all { it < text.length && text[it].isHexDigit() }
+                                if (!hex) throw SerializationException("Invalid unicode escape at offset $pos in manifest JSON")
+                                6
+                            }
+                            else -> throw SerializationException("Invalid escape at offset $pos in manifest JSON")
+                        }
+                    }
+                    c < ' ' -> throw SerializationException("Control character at offset $pos in manifest JSON")
+                    else -> pos++
+                }
+            }
+            throw SerializationException("Unterminated string in manifest JSON")
+        }
+
+        private fun Char.isHexDigit(): Boolean = this in '0'..'9' || this in 'a'..'f' || this in 'A'..'F'
+
+        /**
+         * Checks one value starting at [from] against the JSON grammar, returning the index just
+         * past it. Nesting is bounded like [C2PACbor] so hostile input cannot exhaust the stack.
+         */
+        private fun validateValue(from: Int, depth: Int): Int {
+            if (depth > MAX_DEPTH) throw SerializationException("Manifest JSON nested too deeply")
+            return when (text[from]) {
+                '"' -> skipString(from)
+                '{' -> validateContainer(from, '}', depth) { pos ->
+                    val keyEnd = skipString(pos)
+                    val colon = skipWhitespace(keyEnd)
+                    expect(colon, ':')
+                    validateValue(skipWhitespace(colon + 1), depth + 1)
+                }
+                '[' -> validateContainer(from, ']', depth) { pos -> validateValue(pos, depth + 1) }
+                't' -> literal(from, "true")
+                'f' -> literal(from, "false")
+                'n' -> literal(from, "null")
+                else -> number(from)
+            }
+        }
+
+        private inline fun validateContainer(from: Int, close: Char, depth: Int, member: (Int) -> Int): Int {
+            var pos = skipWhitespace(from + 1)
+            if (text[pos] == close) return pos + 1
+            while (true) {
+                pos = skipWhitespace(member(pos))
+                when (text[pos]) {
+                    ',' -> pos = skipWhitespace(pos + 1)
+                    close -> return pos + 1
+                    else -> throw SerializationException("Expected ',' or '$close' at offset $pos in manifest JSON")
+                }
+            }
+        }
+
+        private fun literal(from: Int, literal: String): Int {
+            if (!text.startsWith(literal, from)) {
+                throw SerializationException("Invalid literal at offset $from in manifest JSON")
+            }
+            return from + literal.length
+        }
+
+        private fun number(from: Int): Int {
+            var pos = from
+            fun digits(): Int {
+                val start = pos
+                while (pos < text.length && text[pos] in '0'..'9') pos++
+                return pos - start
+            }
+            if (text[pos] == '-') pos++
+            val integerStart = pos
+            val integerDigits = digits()
+            if (integerDigits == 0 || (integerDigits > 1 && text[integerStart] == '0')) {
+                throw SerializationException("Invalid number at offset $from in manifest JSON")
+            }
+            if (pos < text.length && text[pos] == '.') {
+                pos++
+                if (digits() == 0) throw SerializationException("Invalid number at offset $from in manifest JSON")
+            }
+            if (pos < text.length && (text[pos] == 'e' || text[pos] == 'E')) {
+                pos++
+                if (pos < text.length && (text[pos] == '+' || text[pos] == '-')) pos++
+                if (digits() == 0) throw SerializationException("Invalid number at offset $from in manifest JSON")
+            }
+            return pos
+        }
+
+        /** Skips one already validated value starting at [from], returning the index just past it. */
+        private fun skipValue(from: Int): Int {
+            when (text[from]) {
+                '"' -> return skipString(from)
+                '{', '[' -> Unit
+                else -> {
+                    // Numbers and literals end at the next delimiter
+                    var pos = from
+                    while (pos < text.length && text[pos] !in ",:}] \n\r\t") pos++
+                    return pos
+                }
+            }
+            var pos = from
+            var depth = 0
+            while (pos < text.length) {
+                when (text[pos]) {
+                    '"' -> {
+                        pos = skipString(pos)
+                        continue
+                    }
+                    '{', '[' -> depth++
+                    '}', ']' -> if (--depth == 0) return pos + 1
+                }
+                pos++
+            }
+            throw SerializationException("Unterminated value in manifest JSON")
+        }
+    }
+
+    class Cbor(private val bytes: ByteArray) : ManifestIndex() {
+
+        override val root: Span = Span(0, skipItem(0, 0))
+
+        override fun entries(span: Span): Map<String, Span>? {
+            val start = skipTags(span.start)
+            if (major(start) != MAJOR_MAP) return null
+            val (count, contentStart) = readArgument(start)
+            val entries = LinkedHashMap<String, Span>()
+            var pos = contentStart
+            var index = 0L
+            while (if (count == INDEFINITE) !isBreak(pos) else index++ < count) {
+                val keyEnd = skipItem(pos)
+                val key = C2PACbor.decodeToJsonElement(bytes, pos, keyEnd).let {
+                    (it as? JsonPrimitive)?.content
+                        ?: throw SerializationException("Unsupported CBOR map key")
+                }
+                val valueEnd = skipItem(keyEnd)
+                entries[key] = Span(keyEnd, valueEnd)
+                pos = valueEnd
+            }
+            return entries
+        }
+
+        override fun elements(span: Span): List<Span>? {
+            val start = skipTags(span.start)
+            if (major(start) != MAJOR_ARRAY) return null
+            val (count, contentStart) = readArgument(start)
+            val elements = ArrayList<Span>()
+            var pos = contentStart
+            var index = 0L
+            while (if (count == INDEFINITE) !isBreak(pos) else index++ < count) {
+                val end = skipItem(pos)
+                elements.add(Span(pos, end))
+                pos = end
+            }
+            return elements
+        }
+
+        override fun isNull(span: Span): Boolean =
+            byteAt(skipTags(span.start)).let { it == 0xF6 || it == 0xF7 }
+
+        override fun isString(span: Span): Boolean = major(skipTags(span.start)) == MAJOR_TEXT
+
+        override fun <T> decode(deserializer: DeserializationStrategy<T>, span: Span): T =
+            C2PAJson.default.decodeFromJsonElement(
+                deserializer,
+                C2PACbor.decodeToJsonElement(bytes, span.start, span.end),
+            )
+
+        private fun major(pos: Int): Int = (byteAt(pos) ushr 5)
+
+        private fun byteAt(pos: Int): Int {
+            if (pos >= bytes.size) throw SerializationException("Unexpected end of manifest CBOR")
+            return bytes[pos].toInt() and 0xFF
+        }
+
+        private fun isBreak(pos: Int): Boolean = byteAt(pos) == 0xFF
+
+        /** Reads the argument of the head at [pos], returning it with the offset after the head. */
+        private fun readArgument(pos: Int): Pair<Long, Int> {
+            val info = byteAt(pos) and 0x1F
+            return when {
+                info < 24 -> info.toLong() to pos + 1
+                info == 31 -> INDEFINITE to pos + 1
+                info > 27 -> throw SerializationException("Invalid CBOR additional info: $info")
+                else -> {
+                    val size = 1 shl (info - 24)
+                    var value = 0L
+                    for (i in 1..size) value = (value shl 8) or byteAt(pos + i).toLong()
+                    // Arguments above Long.MAX_VALUE would wrap negative, and -1 would read as indefinite
+                    if (value < 0) throw SerializationException("CBOR argument out of range")
+                    value to pos + 1 + size
+                }
+            }
+        }
+
+        private fun skipTags(from: Int): Int {
+            var pos = from
+            while (major(pos) == MAJOR_TAG) pos = readArgument(pos).second
+            return pos
+        }
+
+        /**
+         * Skips one data item starting at [from], returning the offset just past it. Nesting is
+         * bounded like [C2PACbor] so hostile input cannot exhaust the stack.
+         */
+        private fun skipItem(from: Int, depth: Int = 0): Int {
+            if (depth > MAX_DEPTH) throw SerializationException("Manifest CBOR nested too deeply")
+            val start = skipTags(from)
+            val major = major(start)
+            val (argument, next) = readArgument(start)
+            return when (major) {
+                MAJOR_BYTES, MAJOR_TEXT -> {
+                    if (argument == INDEFINITE) {
+                        var pos = next
+                        while (!isBreak(pos)) pos = skipItem(pos, depth + 1)
+                        pos + 1
+                    } else {
+                        if (argument > bytes.size - next) {
+                            throw SerializationException("CBOR length exceeds available data")
+                        }
+                        next + argument.toInt()
+                    }
+                }
+                MAJOR_ARRAY, MAJOR_MAP -> {
+                    val itemsPerEntry = if (major == MAJOR_MAP) 2 else 1
+                    var pos = next
+                    if (argument == INDEFINITE) {
+                        while (!isBreak(pos)) repeat(itemsPerEntry) { pos = skipItem(pos, depth + 1) }
+                        pos + 1
+                    } else {
+                        // Every item takes at least one byte
+                        if (argument > bytes.size - next) {
+                            throw SerializationException("CBOR item count exceeds available data")
+                        }
+                        for (i in 0 until argument) repeat(itemsPerEntry) { pos = skipItem(pos, depth + 1) }
+                        pos
+                    }
+                }
+                else -> next
+            }
+        }
+
+        private companion object {
+            const val MAJOR_BYTES = 2
+            const val MAJOR_TEXT = 3
+            const val MAJOR_ARRAY = 4
+            const val MAJOR_MAP = 5
+            const val MAJOR_TAG = 6
+            const val INDEFINITE = -1L
+        }
+    }
+}
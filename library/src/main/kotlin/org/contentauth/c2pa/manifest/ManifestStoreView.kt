@@ -0,0 +1,211 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.manifest
+
+import kotlinx.serialization.builtins.ListSerializer
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * A lazily decoded, typed view over a manifest store as returned by
+ * [org.contentauth.c2pa.Reader.json] or [org.contentauth.c2pa.Reader.cbor].
+ *
+ * The encoded store is scanned once to index where each top-level entry starts and ends.
+ * Manifests, assertions, ingredients and validation entries are only decoded into the
+ * [org.contentauth.c2pa.manifest] model classes when they are accessed, so callers that need a
+ * handful of fields (for example the title and validation state) do not pay for decoding
+ * ingredient trees they never look at. Decoded values are cached.
+ *
+ * Instances are safe to share between threads.
+ *
+ * ```kotlin
+ * val view = ManifestStoreView.fromCbor(reader.cbor())
+ * val active = view.activeManifest()
+ * titleView.text = active?.title
+ * issuerView.text = active?.signatureIssuer
+ * stateView.text = view.validationState
+ * ```
+ *
+ * @see ManifestView
+ */
+class ManifestStoreView private constructor(private val index: ManifestIndex) {
+
+    private val entries: Map<String, Span> by lazy {
+        index.entries(index.root) ?: throw IllegalArgumentException("Manifest store is not an object")
+    }
+
+    private val manifestSpans: Map<String, Span> by lazy {
+        entries["manifests"]?.let { index.entries(it) } ?: emptyMap()
+    }
+
+    private val manifestViews = ConcurrentHashMap<String, ManifestView>()
+
+    /** The label of the active manifest, or null if the store has none. */
+    val activeManifestLabel: String? by lazy { entries["active_manifest"]?.let { index.string(it) } }
+
+    /** The labels of all manifests in the store, in document order. */
+    val manifestLabels: List<String> get() = manifestSpans.keys.toList()
+
+    /** The overall validation state reported by the reader (e.g. "Valid", "Trusted", "Invalid"). */
+    val validationState: String? by lazy { entries["validation_state"]?.let { index.string(it) } }
+
+    /** The validation results for the active manifest and its ingredients, decoded on first access. */
+    val validationResults: ValidationResults? by lazy {
+        entries["validation_results"]?.takeUnless { index.isNull(it) }?.let {
+            index.decode(ValidationResults.serializer(), it)
+        }
+    }
+
+    private val validationStatusSpans: List<Span> by lazy {
+        entries["validation_status"]?.let { index.elements(it) } ?: emptyList()
+    }
+
+    private val validationStatusCache = ConcurrentHashMap<Int, ValidationStatus>()
+
+    /** The number of entries in the store's `validation_status` list. */
+    val validationStatusCount: Int get() = validationStatusSpans.size
+
+    /** Decodes the validation status entry at [position]. */
+    fun validationStatus(position: Int): ValidationStatus {
+        val span = validationStatusSpans[position]
+        return validationStatusCache.getOrPut(position) { index.decode(ValidationStatus.serializer(), span) }
+    }
+
+    /** Decodes all validation status entries. */
+    fun validationStatus(): List<ValidationStatus> = validationStatusSpans.indices.map { validationStatus(it) }
+
+    /** Returns the active manifest, or null if the store has none. */
+    fun activeManifest(): ManifestView? = activeManifestLabel?.let { manifest(it) }
+
+    /** Returns the manifest with the given [label], or null if it is not in the store. */
+    fun manifest(label: String): ManifestView? {
+        val span = manifestSpans[label] ?: return null
+        return manifestViews.getOrPut(label) { ManifestView(index, label, span) }
+    }
+
+    companion object {
+        /**
+         * Creates a view over a manifest store JSON string.
+         *
+         * @throws kotlinx.serialization.SerializationException if the JSON is malformed.
+         */
+        @JvmStatic
+        fun fromJson(json: String): ManifestStoreView = ManifestStoreView(ManifestIndex.Json(json))
+
+        /**
+         * Creates a view over a manifest store encoded as CBOR.
+         *
+         * @throws kotlinx.serialization.SerializationException if the CBOR is malformed.
+         */
+        @JvmStatic
+        fun fromCbor(cbor: ByteArray): ManifestStoreView = ManifestStoreView(ManifestIndex.Cbor(cbor))
+    }
+}
+
+/**
+ * A lazily decoded view of one manifest inside a [ManifestStoreView].
+ *
+ * Scalar fields are decoded on first access. Assertions and ingredients are indexed but only
+ * decoded individually, through [assertion] and [ingredient], and each is decoded at most once.
+ *
+ * @property label The manifest label.
+ */
+class ManifestView internal constructor(
+    private val index: ManifestIndex,
+    val label: String,
+    span: Span,
+) {
+    private val entries: Map<String, Span> by lazy { index.entries(span) ?: emptyMap() }
+
+    private val signatureEntries: Map<String, Span> by lazy {
+        entries["signature_info"]?.let { index.entries(it) } ?: emptyMap()
+    }
+
+    private val assertionSpans: List<Span> by lazy { list("assertions") }
+
+    private val assertionCache = ConcurrentHashMap<Int, AssertionDefinition>()
+
+    private val ingredientCache = ConcurrentHashMap<Int, Ingredient>()
+
+    private val ingredientSpans: List<Span> by lazy { list("ingredients") }
+
+    private val assertionLabelList: List<String?> by lazy {
+        assertionSpans.map { span -> index.entries(span)?.get("label")?.let { index.string(it) } }
+    }
+
+    /** The manifest title. */
+    val title: String? by lazy { string("title") }
+
+    /** The asset format (MIME type) recorded in the manifest. */
+    val format: String? by lazy { string("format") }
+
+    /** The instance identifier of the asset. */
+    val instanceId: String? by lazy { string("instance_id") }
+
+    /** The legacy claim generator string, if present. */
+    val claimGenerator: String? by lazy { string("claim_generator") }
+
+    /** The claim generator info entries. */
+    val claimGeneratorInfo: List<ClaimGeneratorInfo> by lazy {
+        entries["claim_generator_info"]?.takeUnless { index.isNull(it) }?.let {
+            index.decode(ListSerializer(ClaimGeneratorInfo.serializer()), it)
+        } ?: emptyList()
+    }
+
+    /** The issuer of the signing certificate. */
+    val signatureIssuer: String? by lazy { signatureString("issuer") }
+
+    /** The common name of the signing certificate. */
+    val signatureCommonName: String? by lazy { signatureString("common_name") }
+
+    /** The signing time, if the signature was timestamped. */
+    val signatureTime: String? by lazy { signatureString("time") }
+
+    /** The signing algorithm. */
+    val signatureAlgorithm: String? by lazy { signatureString("alg") }
+
+    /** The number of assertions in the manifest. */
+    val assertionCount: Int get() = assertionSpans.size
+
+    /** The assertion labels in document order, read without decoding assertion data. */
+    val assertionLabels: List<String> get() = assertionLabelList.filterNotNull()
+
+    /** The number of ingredients in the manifest. */
+    val ingredientCount: Int get() = ingredientSpans.size
+
+    /** Decodes the assertion at [position]. */
+    fun assertion(position: Int): AssertionDefinition {
+        val span = assertionSpans[position]
+        return assertionCache.getOrPut(position) { index.decode(AssertionDefinition.serializer(), span) }
+    }
+
+    /** Decodes the first assertion with the given [label], or returns null if there is none. */
+    fun assertion(label: String): AssertionDefinition? {
+        val position = assertionLabelList.indexOf(label)
+        return if (position < 0) null else assertion(position)
+    }
+
+    /** Decodes the ingredient at [position]. */
+    fun ingredient(position: Int): Ingredient {
+        val span = ingredientSpans[position]
+        return ingredientCache.getOrPut(position) { index.decode(Ingredient.serializer(), span) }
+    }
+
+    /** Decodes all ingredients. */
+    fun ingredients(): List<Ingredient> = ingredientSpans.indices.map { ingredient(it) }
+
+    private fun list(key: String): List<Span> = entries[key]?.let { index.elements(it) } ?: emptyList()
+
+    private fun string(key: String): String? = entries[key]?.let { index.string(it) }
+
+    private fun signatureString(key: String): String? = signatureEntries[key]?.let { index.string(it) }
+}
@@ -13,12 +13,8 @@ each license.
 package org.contentauth.c2pa.manifest
 
 import android.util.Log
-import kotlinx.serialization.json.JsonObject
-import org.contentauth.c2pa.C2PAJson
+import kotlinx.serialization.json.JsonPrimitive
 import kotlinx.serialization.json.intOrNull
-import kotlinx.serialization.json.jsonArray
-import kotlinx.serialization.json.jsonObject
-import kotlinx.serialization.json.jsonPrimitive
 
 /**
  * Validates C2PA manifests for spec compliance and provides warnings for common issues.
@@ -43,21 +39,48 @@ object ManifestValidator {
 
     private const val TAG = "C2PA"
 
+    /**
+     * Replacement guidance for each deprecated assertion label, keyed by label.
+     */
+    private val DEPRECATED_REPLACEMENTS: Map<String, String> = linkedMapOf(
+        "stds.exif" to "Consider using c2pa.metadata or embedding EXIF in the asset directly.",
+        "stds.iptc.photo-metadata" to "Consider using c2pa.metadata instead.",
+        "stds.schema-org.CreativeWork" to "Consider using c2pa.metadata instead.",
+        "c2pa.endorsement" to "Endorsement assertions are no longer supported in C2PA 2.x.",
+        "c2pa.data" to "Use c2pa.embedded-data instead.",
+        "c2pa.databoxes" to "Data box stores are deprecated in C2PA 2.x.",
+        "c2pa.font.info" to "Use font.info instead.",
+        "c2pa.training-mining" to "Use cawg.training-mining instead.",
+    )
+
     /**
      * Deprecated assertion labels per C2PA 2.x specification.
      * These are still supported but should not be used in new manifests.
      */
-    val DEPRECATED_ASSERTION_LABELS: Set<String> = setOf(
-        "stds.exif",
-        "stds.iptc.photo-metadata",
-        "stds.schema-org.CreativeWork",
-        "c2pa.endorsement",
-        "c2pa.data",
-        "c2pa.databoxes",
-        "c2pa.font.info",
-        "c2pa.training-mining",
+    val DEPRECATED_ASSERTION_LABELS: Set<String> = DEPRECATED_REPLACEMENTS.keys
+
+    /**
+     * Custom labels that are likely misspellings of standard labels, mapped to the intended label.
+     */
+    private val COMMON_TYPOS: Map<String, String> = hashMapOf(
+        "c2pa.action" to "c2pa.actions",
+        "stds.iptc" to "stds.iptc.photo-metadata",
+        "cawg.training" to "cawg.training-mining",
     )
 
+    // Warning text is built once per label so validation only does hash lookups
+    private val DEPRECATION_WARNINGS: Map<String, String> = DEPRECATED_REPLACEMENTS.mapValuesTo(HashMap()) {
+        "Assertion '${it.key}' is deprecated in C2PA 2.x. ${it.value}"
+    }
+
+    private val JSON_DEPRECATION_WARNINGS: Map<String, String> = DEPRECATED_REPLACEMENTS.mapValuesTo(HashMap()) {
+        "Assertion '${it.key}' in assertions is deprecated in C2PA 2.x. ${it.value}"
+    }
+
+    private val TYPO_WARNINGS: Map<String, String> = COMMON_TYPOS.mapValuesTo(HashMap()) {
+        "Label '${it.key}' may be a typo. Did you mean '${it.value}'?"
+    }
+
     /**
      * The current recommended claim version for C2PA 2.x specification.
      */
@@ -118,14 +141,7 @@ object ManifestValidator {
                     )
                 }
                 // Check for common typos in standard labels
-                val commonTypos = mapOf(
-                    "c2pa.action" to "c2pa.actions",
-                    "stds.iptc" to "stds.iptc.photo-metadata",
-                    "cawg.training" to "cawg.training-mining",
-                )
-                commonTypos[label]?.let { correct ->
-                    warnings.add("Label '$label' may be a typo. Did you mean '$correct'?")
-                }
+                TYPO_WARNINGS[label]?.let { warnings.add(it) }
             }
             else -> {
                 // Standard types have validated labels
@@ -141,35 +157,14 @@ object ManifestValidator {
         warnings: MutableList<String>,
     ) {
         assertions.forEach { assertion ->
-            val label = assertion.baseLabel()
-            if (label in DEPRECATED_ASSERTION_LABELS) {
-                val replacement = getDeprecatedAssertionReplacement(label)
-                warnings.add(
-                    "Assertion '$label' is deprecated in C2PA 2.x. $replacement",
-                )
-            }
+            DEPRECATION_WARNINGS[assertion.baseLabel()]?.let { warnings.add(it) }
         }
     }
 
-    /**
-     * Returns replacement guidance for deprecated assertion labels.
-     */
-    private fun getDeprecatedAssertionReplacement(label: String): String = when (label) {
-        "stds.exif" -> "Consider using c2pa.metadata or embedding EXIF in the asset directly."
-        "stds.iptc.photo-metadata" -> "Consider using c2pa.metadata instead."
-        "stds.schema-org.CreativeWork" -> "Consider using c2pa.metadata instead."
-        "c2pa.endorsement" -> "Endorsement assertions are no longer supported in C2PA 2.x."
-        "c2pa.data" -> "Use c2pa.embedded-data instead."
-        "c2pa.databoxes" -> "Data box stores are deprecated in C2PA 2.x."
-        "c2pa.font.info" -> "Use font.info instead."
-        "c2pa.training-mining" -> "Use cawg.training-mining instead."
-        else -> "Check the C2PA 2.3 specification for current alternatives."
-    }
-
     /**
      * Validates a raw JSON manifest string and logs warnings to the console.
      *
-     * This method parses the JSON and checks for:
+     * This method indexes the JSON without building a full element tree and checks for:
      * - Non-v2 claim versions
      * - Deprecated assertion labels
      * - CAWG assertions in wrong location
@@ -184,10 +179,16 @@ object ManifestValidator {
         val warnings = mutableListOf<String>()
 
         try {
-            val jsonObject = C2PAJson.default.parseToJsonElement(manifestJson).jsonObject
+            // Index the document instead of building a full tree; only the fields checked
+            // below are decoded
+            val index = ManifestIndex.Json(manifestJson)
+            val fields = index.entries(index.root)
+                ?: throw IllegalArgumentException("Manifest JSON must be an object")
 
             // Check claim_version
-            val claimVersion = jsonObject["claim_version"]?.jsonPrimitive?.intOrNull
+            val claimVersion = fields["claim_version"]?.let {
+                index.decode(JsonPrimitive.serializer(), it).intOrNull
+            }
             if (claimVersion != null && claimVersion != RECOMMENDED_CLAIM_VERSION) {
                 warnings.add(
                     "claim_version is $claimVersion, but C2PA 2.x recommends version $RECOMMENDED_CLAIM_VERSION. " +
@@ -197,14 +198,12 @@ object ManifestValidator {
             }
 
             // Check assertions for deprecated labels
-            jsonObject["assertions"]?.jsonArray?.forEach { assertionElement ->
-                val assertionObj = assertionElement.jsonObject
-                val label = assertionObj["label"]?.jsonPrimitive?.content
+            fields["assertions"]?.let { index.elements(it) }?.forEach { assertion ->
+                val label = index.entries(assertion)?.get("label")?.let { index.string(it) }
                 if (label != null) {
-                    checkJsonAssertionLabel(label, warnings, "assertions")
+                    checkJsonAssertionLabel(label, warnings)
                 }
             }
-
         } catch (e: Exception) {
             errors.add("Failed to parse manifest JSON: ${e.message}")
         }
@@ -220,19 +219,8 @@ object ManifestValidator {
     /**
      * Checks a JSON assertion label for deprecation and issues.
      */
-    private fun checkJsonAssertionLabel(
-        label: String,
-        warnings: MutableList<String>,
-        location: String,
-    ) {
-        // Check for deprecated labels
-        if (label in DEPRECATED_ASSERTION_LABELS) {
-            val replacement = getDeprecatedAssertionReplacement(label)
-            warnings.add(
-                "Assertion '$label' in $location is deprecated in C2PA 2.x. $replacement",
-            )
-        }
-
+    private fun checkJsonAssertionLabel(label: String, warnings: MutableList<String>) {
+        JSON_DEPRECATION_WARNINGS[label]?.let { warnings.add(it) }
     }
 
     /**
@@ -247,6 +235,33 @@ object ManifestValidator {
         }
     }
 
+    /**
+     * Validates a batch of manifest definitions.
+     *
+     * Equivalent to calling [validate] for each manifest; the rule tables are shared across the
+     * batch, so this is suitable for validating many manifests before a bulk signing run.
+     *
+     * @param manifests The manifests to validate.
+     * @return One ManifestValidationResult per manifest, in the same order.
+     */
+    fun validateAll(manifests: List<ManifestDefinition>): List<ManifestValidationResult> =
+        manifests.map { validate(it) }
+
+    /**
+     * Validates a batch of raw JSON manifest strings.
+     *
+     * Equivalent to calling [validateJson] for each manifest, with results logged together when
+     * [logWarnings] is true.
+     *
+     * @param manifestJsons The manifest JSON strings to validate.
+     * @param logWarnings If true, warnings are logged to the Android console.
+     * @return One ManifestValidationResult per manifest, in the same order.
+     */
+    fun validateJsonAll(
+        manifestJsons: List<String>,
+        logWarnings: Boolean = false,
+    ): List<ManifestValidationResult> = manifestJsons.map { validateJson(it, logWarnings) }
+
     /**
      * Validates and logs warnings for a ManifestDefinition.
      *
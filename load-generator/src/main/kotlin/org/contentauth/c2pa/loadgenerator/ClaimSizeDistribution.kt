@@ -0,0 +1,66 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+import kotlin.random.Random
+
+/**
+ * Weighted distribution of claim sizes.
+ *
+ * The claim a device sends is the COSE `Sig_structure` over the claim, so its size grows with the
+ * number of assertions and ingredients. The default mix is weighted towards the small claims of
+ * single-capture photos, with a tail of large edited-asset claims.
+ */
+class ClaimSizeDistribution(private val sizes: IntArray, weights: DoubleArray) {
+    private val cumulative: DoubleArray
+
+    init {
+        require(sizes.isNotEmpty() && sizes.size == weights.size) { "Claim sizes and weights must match" }
+        require(sizes.all { it > 0 } && weights.all { it > 0 }) { "Claim sizes and weights must be positive" }
+        val total = weights.sum()
+        var running = 0.0
+        cumulative = DoubleArray(weights.size) { i ->
+            running += weights[i] / total
+            running
+        }
+    }
+
+    /** Picks a claim size. */
+    fun sample(random: Random): Int {
+        val point = random.nextDouble()
+        val index = cumulative.indexOfFirst { point < it }
+        return sizes[if (index < 0) sizes.lastIndex else index]
+    }
+
+    override fun toString(): String = sizes.indices.joinToString(",") { i ->
+        val weight = cumulative[i] - (if (i == 0) 0.0 else cumulative[i - 1])
+        "${sizes[i]}:${"%.2f".format(weight)}"
+    }
+
+    companion object {
+        val DEFAULT = parse("1024:0.3,2048:0.4,4096:0.2,16384:0.1")
+
+        /** Parses `size:weight` pairs separated by commas. */
+        fun parse(spec: String): ClaimSizeDistribution {
+            val pairs = spec.split(',').map { entry ->
+                val parts = entry.trim().split(':')
+                require(parts.size == 2) { "Invalid claim size entry: $entry" }
+                parts[0].toInt() to parts[1].toDouble()
+            }
+            return ClaimSizeDistribution(
+                pairs.map { it.first }.toIntArray(),
+                pairs.map { it.second }.toDoubleArray(),
+            )
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+import kotlinx.serialization.Serializable
+import java.util.concurrent.atomic.AtomicLong
+
+/** How a request ended. */
+enum class Outcome {
+    /** 2xx response. */
+    SUCCESS,
+
+    /** 429 from the server's admission control. */
+    REJECTED,
+
+    /** 503, typically a signing deadline that passed. */
+    UNAVAILABLE,
+
+    /** Any other status. */
+    HTTP_ERROR,
+
+    /** No response: connection failure or client timeout. */
+    TRANSPORT_ERROR,
+}
+
+/**
+ * Records latencies and outcomes for one kind of request.
+ *
+ * Latencies are kept in full, in microseconds, so percentiles are exact rather than bucketed. At
+ * the request rates a single host can generate this is a few megabytes per minute.
+ */
+class LatencyRecorder(val operation: String) {
+    private var samples = LongArray(1 shl 16)
+    private var count = 0
+    private val outcomes = Array(Outcome.entries.size) { AtomicLong() }
+
+    /** Records one request. Requests that never got a response still count towards latency. */
+    fun record(latencyNanos: Long, outcome: Outcome) {
+        outcomes[outcome.ordinal].incrementAndGet()
+        synchronized(this) {
+            if (count == samples.size) {
+                samples = samples.copyOf(samples.size * 2)
+            }
+            samples[count++] = latencyNanos / 1000
+        }
+    }
+
+    /** Summarizes everything recorded so far over a window of [elapsedSeconds]. */
+    fun summarize(elapsedSeconds: Double): OperationSummary {
+        val sorted = synchronized(this) { samples.copyOf(count) }.also { it.sort() }
+        fun percentile(p: Double): Double =
+            if (sorted.isEmpty()) 0.0 else sorted[((sorted.size - 1) * p).toInt()] / 1000.0
+        val succeeded = outcomes[Outcome.SUCCESS.ordinal].get()
+        return OperationSummary(
+            operation = operation,
+            requests = sorted.size.toLong(),
+            succeeded = succeeded,
+            rejected = outcomes[Outcome.REJECTED.ordinal].get(),
+            unavailable = outcomes[Outcome.UNAVAILABLE.ordinal].get(),
+            httpErrors = outcomes[Outcome.HTTP_ERROR.ordinal].get(),
+            transportErrors = outcomes[Outcome.TRANSPORT_ERROR.ordinal].get(),
+            throughputPerSecond = if (elapsedSeconds > 0) succeeded / elapsedSeconds else 0.0,
+            meanMillis = if (sorted.isEmpty()) 0.0 else sorted.average() / 1000.0,
+            p50Millis = percentile(0.50),
+            p90Millis = percentile(0.90),
+            p99Millis = percentile(0.99),
+            p999Millis = percentile(0.999),
+            maxMillis = percentile(1.0),
+        )
+    }
+}
+
+/** Latency and outcome summary for one kind of request. */
+@Serializable
+data class OperationSummary(
+    val operation: String,
+    val requests: Long,
+    val succeeded: Long,
+    val rejected: Long,
+    val unavailable: Long,
+    val httpErrors: Long,
+    val transportErrors: Long,
+    val throughputPerSecond: Double,
+    val meanMillis: Double,
+    val p50Millis: Double,
+    val p90Millis: Double,
+    val p99Millis: Double,
+    val p999Millis: Double,
+    val maxMillis: Double,
+)
@@ -0,0 +1,88 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+/**
+ * Load generator settings.
+ *
+ * @property baseUrl Base URL of the signing server
+ * @property bearerToken Token sent with every request, as `WebServiceSigner` does
+ * @property arrivalRate Sessions started per second (open loop); 0 runs closed loop instead
+ * @property concurrency Maximum sessions in flight. In closed loop this is the number of
+ * clients; in open loop, arrivals beyond it are counted as client-side drops
+ * @property durationSeconds How long to generate load
+ * @property warmupSeconds Initial period whose results are discarded
+ * @property signsPerSession Sign calls made with each fetched configuration
+ * @property claimSizes Distribution of claim sizes, in bytes
+ * @property useConfiguredSigningUrl Sign against the URL returned by the configuration endpoint
+ * instead of [baseUrl]. The server reports the URL devices use, which may not be reachable here
+ * @property reportPath Optional path for a JSON report
+ * @property label Free-form label recorded in the report, such as a release version
+ */
+data class LoadConfig(
+    val baseUrl: String = "http://localhost:8080",
+    val bearerToken: String? = System.getenv("BEARER_TOKEN"),
+    val arrivalRate: Double = 50.0,
+    val concurrency: Int = 64,
+    val durationSeconds: Int = 60,
+    val warmupSeconds: Int = 5,
+    val signsPerSession: Int = 1,
+    val claimSizes: ClaimSizeDistribution = ClaimSizeDistribution.DEFAULT,
+    val useConfiguredSigningUrl: Boolean = false,
+    val reportPath: String? = null,
+    val label: String? = null,
+) {
+    companion object {
+        const val USAGE = """Usage: load-generator [options]
+  --url <url>                 Signing server base URL (default http://localhost:8080)
+  --token <token>             Bearer token (default ${'$'}BEARER_TOKEN)
+  --rate <sessions/s>         Open-loop arrival rate; 0 for closed loop (default 50)
+  --concurrency <n>           Max sessions in flight / closed-loop clients (default 64)
+  --duration <seconds>        Measurement duration (default 60)
+  --warmup <seconds>          Discarded warm-up period (default 5)
+  --signs-per-session <n>     Sign calls per configuration fetch (default 1)
+  --claim-sizes <spec>        Weighted sizes, e.g. 1024:0.3,2048:0.4,4096:0.2,16384:0.1
+  --use-configured-url        Sign against the URL returned by the configuration endpoint
+  --report <path>             Write a JSON report to <path>
+  --label <text>              Label recorded in the report (e.g. a release version)"""
+
+        /** Parses command-line arguments. */
+        fun fromArgs(args: Array<String>): LoadConfig {
+            var config = LoadConfig()
+            var i = 0
+            fun value(): String = args.getOrNull(++i) ?: throw IllegalArgumentException("Missing value for ${args[i - 1]}")
+            while (i < args.size) {
+                config = when (args[i]) {
+                    "--url" -> config.copy(baseUrl = value().trimEnd('/'))
+                    "--token" -> config.copy(bearerToken = value())
+                    "--rate" -> config.copy(arrivalRate = value().toDouble())
+                    "--concurrency" -> config.copy(concurrency = value().toInt())
+                    "--duration" -> config.copy(durationSeconds = value().toInt())
+                    "--warmup" -> config.copy(warmupSeconds = value().toInt())
+                    "--signs-per-session" -> config.copy(signsPerSession = value().toInt())
+                    "--claim-sizes" -> config.copy(claimSizes = ClaimSizeDistribution.parse(value()))
+                    "--use-configured-url" -> config.copy(useConfiguredSigningUrl = true)
+                    "--report" -> config.copy(reportPath = value())
+                    "--label" -> config.copy(label = value())
+                    else -> throw IllegalArgumentException("Unknown option: ${args[i]}")
+                }
+                i++
+            }
+            require(config.arrivalRate >= 0) { "--rate must not be negative" }
+            require(config.concurrency > 0) { "--concurrency must be positive" }
+            require(config.durationSeconds > 0) { "--duration must be positive" }
+            require(config.signsPerSession > 0) { "--signs-per-session must be positive" }
+            return config
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+import kotlinx.serialization.Serializable
+import kotlinx.serialization.encodeToString
+import kotlinx.serialization.json.Json
+import java.io.File
+
+/**
+ * Results of one load run. The JSON form is stable so that reports from different server
+ * versions can be compared.
+ */
+@Serializable
+data class LoadReport(
+    val label: String?,
+    val baseUrl: String,
+    val mode: String,
+    val arrivalRate: Double,
+    val concurrency: Int,
+    val durationSeconds: Double,
+    val claimSizes: String,
+    val signsPerSession: Int,
+    val droppedSessions: Long,
+    val claimBytes: Long,
+    val operations: List<OperationSummary>,
+) {
+    /** Formats the report as a table for the console. */
+    fun toText(): String = buildString {
+        appendLine("Target:     $baseUrl${label?.let { " ($it)" } ?: ""}")
+        val load = if (mode == "open") "%.1f sessions/s open loop, max %d in flight".format(arrivalRate, concurrency)
+        else "$concurrency closed-loop clients"
+        appendLine("Load:       $load, $signsPerSession sign(s) per session")
+        appendLine("Claims:     $claimSizes (bytes:weight)")
+        appendLine("Measured:   %.1f s, %d dropped sessions".format(durationSeconds, droppedSessions))
+        appendLine()
+        appendLine(
+            "%-14s %9s %9s %7s %7s %7s %9s %9s %9s %9s %9s %9s".format(
+                "operation", "requests", "ok/s", "429", "503", "errors",
+                "mean ms", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms",
+            ),
+        )
+        for (op in operations) {
+            appendLine(
+                "%-14s %9d %9.1f %7d %7d %7d %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f".format(
+                    op.operation, op.requests, op.throughputPerSecond, op.rejected, op.unavailable,
+                    op.httpErrors + op.transportErrors,
+                    op.meanMillis, op.p50Millis, op.p90Millis, op.p99Millis, op.p999Millis, op.maxMillis,
+                ),
+            )
+        }
+    }
+
+    /** Writes the report as JSON to [path]. */
+    fun writeJson(path: String) {
+        File(path).writeText(json.encodeToString(this))
+    }
+
+    private companion object {
+        val json = Json { prettyPrint = true }
+    }
+}
@@ -0,0 +1,204 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.future.await
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.serialization.json.Json
+import kotlinx.serialization.json.jsonObject
+import kotlinx.serialization.json.jsonPrimitive
+import java.net.URI
+import java.net.http.HttpClient
+import java.net.http.HttpRequest
+import java.net.http.HttpResponse
+import java.time.Duration
+import java.util.Base64
+import java.util.concurrent.atomic.AtomicLong
+import kotlin.math.ln
+import kotlin.random.Random
+
+/**
+ * Replays device signing traffic against the signing server.
+ *
+ * Each session does what `WebServiceSigner` does on a device: fetch the signing configuration,
+ * then post one or more claims to the signing URL and wait for the signatures. Claim bytes are
+ * random, sized by [LoadConfig.claimSizes]; the server signs whatever it is given.
+ *
+ * With a positive [LoadConfig.arrivalRate] sessions arrive as a Poisson process, independent of
+ * how fast the server answers, which is how a fleet of devices behaves. Latencies are measured
+ * from each session's scheduled start, so queueing the server causes is not hidden by the
+ * generator slowing down (coordinated omission). Arrivals that would exceed
+ * [LoadConfig.concurrency] sessions in flight are dropped and counted. With a rate of 0, that
+ * many closed-loop clients run back to back instead, which finds peak throughput.
+ */
+class LoadRunner(private val config: LoadConfig) {
+    private val client: HttpClient = HttpClient.newBuilder()
+        .connectTimeout(Duration.ofSeconds(5))
+        .version(HttpClient.Version.HTTP_1_1)
+        .build()
+
+    private val configuration = LatencyRecorder("configuration")
+    private val sign = LatencyRecorder("sign")
+    private val session = LatencyRecorder("session")
+    private val dropped = AtomicLong()
+    private val claimBytes = AtomicLong()
+
+    @Volatile
+    private var measuring = false
+
+    /** Runs the load for the configured warm-up and duration, then returns the report. */
+    suspend fun run(): LoadReport = coroutineScope {
+        val totalNanos = (config.warmupSeconds + config.durationSeconds) * 1_000_000_000L
+        val start = System.nanoTime()
+        val warmupEnd = start + config.warmupSeconds * 1_000_000_000L
+        val end = start + totalNanos
+
+        launch {
+            delay(config.warmupSeconds * 1000L)
+            measuring = true
+        }
+
+        if (config.arrivalRate > 0) {
+            runOpenLoop(warmupEnd, end)
+        } else {
+            runClosedLoop(end)
+        }
+
+        val elapsedSeconds = (System.nanoTime() - warmupEnd) / 1e9
+        LoadReport(
+            label = config.label,
+            baseUrl = config.baseUrl,
+            mode = if (config.arrivalRate > 0) "open" else "closed",
+            arrivalRate = config.arrivalRate,
+            concurrency = config.concurrency,
+            durationSeconds = elapsedSeconds,
+            claimSizes = config.claimSizes.toString(),
+            signsPerSession = config.signsPerSession,
+            droppedSessions = dropped.get(),
+            claimBytes = claimBytes.get(),
+            operations = listOf(configuration, sign, session).map { it.summarize(elapsedSeconds) },
+        )
+    }
+
+    private suspend fun runOpenLoop(warmupEnd: Long, end: Long) = coroutineScope {
+        val inFlight = Semaphore(config.concurrency)
+        val random = Random(System.nanoTime())
+        val meanGapNanos = 1e9 / config.arrivalRate
+        var next = System.nanoTime()
+        while (next < end) {
+            val waitNanos = next - System.nanoTime()
+            if (waitNanos > 0) delay(waitNanos / 1_000_000)
+            val scheduled = next
+            if (inFlight.tryAcquire()) {
+                val seed = random.nextInt()
+                launch(Dispatchers.IO) {
+                    try {
+                        runSession(scheduled, seed)
+                    } finally {
+                        inFlight.release()
+                    }
+                }
+            } else if (scheduled >= warmupEnd) {
+                dropped.incrementAndGet()
+            }
+            // Exponential inter-arrival times give a Poisson arrival process
+            next += (-ln(1.0 - random.nextDouble()) * meanGapNanos).toLong()
+        }
+    }
+
+    private suspend fun runClosedLoop(end: Long) = coroutineScope {
+        repeat(config.concurrency) { worker ->
+            launch(Dispatchers.IO) {
+                val seed = worker * 31 + System.nanoTime().toInt()
+                var iteration = 0
+                while (isActive && System.nanoTime() < end) {
+                    runSession(System.nanoTime(), seed + iteration++)
+                }
+            }
+        }
+    }
+
+    private suspend fun runSession(scheduled: Long, seed: Int) {
+        val random = Random(seed)
+        val record = measuring
+        val configStart = System.nanoTime()
+        val (configOutcome, signingUrl) = fetchConfiguration()
+        if (record) configuration.record(System.nanoTime() - configStart, configOutcome)
+
+        var outcome = configOutcome
+        if (signingUrl != null) {
+            repeat(config.signsPerSession) {
+                val claim = ByteArray(config.claimSizes.sample(random)).also { random.nextBytes(it) }
+                val signStart = System.nanoTime()
+                val signOutcome = postClaim(signingUrl, claim)
+                if (record) {
+                    sign.record(System.nanoTime() - signStart, signOutcome)
+                    claimBytes.addAndGet(claim.size.toLong())
+                }
+                if (signOutcome != Outcome.SUCCESS && outcome == Outcome.SUCCESS) outcome = signOutcome
+            }
+        }
+        if (record) session.record(System.nanoTime() - scheduled, outcome)
+    }
+
+    private suspend fun fetchConfiguration(): Pair<Outcome, String?> {
+        val request = authorized(HttpRequest.newBuilder(URI.create("${config.baseUrl}/api/v1/c2pa/configuration")))
+            .GET()
+            .build()
+        val response = send(request) ?: return Outcome.TRANSPORT_ERROR to null
+        val outcome = outcomeOf(response.statusCode())
+        if (outcome != Outcome.SUCCESS) return outcome to null
+        val signingUrl = if (config.useConfiguredSigningUrl) {
+            runCatching {
+                Json.parseToJsonElement(response.body()).jsonObject["signing_url"]?.jsonPrimitive?.content
+            }.getOrNull() ?: return Outcome.HTTP_ERROR to null
+        } else {
+            "${config.baseUrl}/api/v1/c2pa/sign"
+        }
+        return outcome to signingUrl
+    }
+
+    private suspend fun postClaim(signingUrl: String, claim: ByteArray): Outcome {
+        val body = """{"claim":"${Base64.getEncoder().encodeToString(claim)}"}"""
+        val request = authorized(HttpRequest.newBuilder(URI.create(signingUrl)))
+            .header("Content-Type", "application/json")
+            .POST(HttpRequest.BodyPublishers.ofString(body))
+            .build()
+        val response = send(request) ?: return Outcome.TRANSPORT_ERROR
+        return outcomeOf(response.statusCode())
+    }
+
+    private fun authorized(builder: HttpRequest.Builder): HttpRequest.Builder {
+        builder.timeout(Duration.ofSeconds(30))
+        config.bearerToken?.let { builder.header("Authorization", "Bearer $it") }
+        return builder
+    }
+
+    private suspend fun send(request: HttpRequest): HttpResponse<String>? = try {
+        client.sendAsync(request, HttpResponse.BodyHandlers.ofString()).await()
+    } catch (e: Exception) {
+        null
+    }
+
+    private fun outcomeOf(status: Int): Outcome = when (status) {
+        in 200..299 -> Outcome.SUCCESS
+        429 -> Outcome.REJECTED
+        503 -> Outcome.UNAVAILABLE
+        else -> Outcome.HTTP_ERROR
+    }
+}
@@ -0,0 +1,42 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.loadgenerator
+
+import kotlinx.coroutines.runBlocking
+import kotlin.system.exitProcess
+
+fun main(args: Array<String>) {
+    if (args.contains("--help") || args.contains("-h")) {
+        println(LoadConfig.USAGE)
+        return
+    }
+
+    val config = try {
+        LoadConfig.fromArgs(args)
+    } catch (e: IllegalArgumentException) {
+        System.err.println(e.message)
+        System.err.println(LoadConfig.USAGE)
+        exitProcess(2)
+    }
+
+    println("Warming up for ${config.warmupSeconds} s, then measuring for ${config.durationSeconds} s...")
+    val report = runBlocking { LoadRunner(config).run() }
+
+    println()
+    print(report.toText())
+    config.reportPath?.let {
+        report.writeJson(it)
+        println()
+        println("Report written to $it")
+    }
+}
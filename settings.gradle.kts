@@ -31,3 +31,4 @@ include(":test-shared")
 include(":test-app:app")
 include(":example-app:app")
 include(":signing-server")
+include(":load-generator")
@@ -51,6 +51,19 @@ tasks.test {
     useJUnitPlatform()
 }
 
+val benchmark: SourceSet by sourceSets.creating {
+    compileClasspath += sourceSets.main.get().output + sourceSets.main.get().compileClasspath
+    runtimeClasspath += sourceSets.main.get().output + sourceSets.main.get().runtimeClasspath
+}
+
+tasks.register<JavaExec>("benchmarkCertificates") {
+    group = "verification"
+    description = "Measures certificate issuance throughput in certificates per second"
+    classpath = benchmark.runtimeClasspath
+    mainClass.set("org.contentauth.c2pa.signingserver.benchmark.CertificateIssuanceBenchmarkKt")
+    args = (project.findProperty("benchmarkArgs") as String?)?.split(" ") ?: emptyList()
+}
+
 application {
     mainClass.set("org.contentauth.c2pa.signingserver.ApplicationKt")
     val isDevelopment: Boolean = project.ext.has("development")
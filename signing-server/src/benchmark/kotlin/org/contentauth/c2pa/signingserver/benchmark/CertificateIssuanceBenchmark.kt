@@ -0,0 +1,102 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.signingserver.benchmark
+
+import kotlinx.coroutines.runBlocking
+import org.bouncycastle.asn1.x500.X500Name
+import org.bouncycastle.operator.jcajce.JcaContentSignerBuilder
+import org.bouncycastle.pkcs.jcajce.JcaPKCS10CertificationRequestBuilder
+import org.bouncycastle.util.io.pem.PemObject
+import org.bouncycastle.util.io.pem.PemWriter
+import org.contentauth.c2pa.signingserver.config.KeyPoolConfig
+import org.contentauth.c2pa.signingserver.services.CertificateSigningService
+import org.contentauth.c2pa.signingserver.services.KeyPairPool
+import java.io.StringWriter
+import java.security.KeyPairGenerator
+import java.security.spec.ECGenParameterSpec
+
+/**
+ * Measures certificate issuance in certificates per second, in-process, for:
+ *
+ * - temporary certificates with a key generated per certificate (no pool)
+ * - temporary certificates drawn from a full key pool, as during the start of an enrollment burst
+ * - CSR signing one request at a time
+ * - CSR signing in batches of [CertificateSigningService.MAX_BATCH_SIZE]
+ *
+ * Usage: `./gradlew :signing-server:benchmarkCertificates -PbenchmarkArgs="2000"`, where the
+ * argument is the number of certificates per scenario.
+ */
+fun main(args: Array<String>) {
+    val count = args.firstOrNull()?.toIntOrNull() ?: 1000
+    val warmup = count / 5
+
+    println("Issuing $count certificates per scenario after $warmup warm-up certificates")
+    println()
+
+    KeyPairPool(KeyPoolConfig(capacity = 0)).use { pool ->
+        val service = CertificateSigningService(pool)
+        report("temporary, no key pool", count) {
+            repeat(warmup) { service.generateTemporaryCertificate() }
+            measure { repeat(count) { service.generateTemporaryCertificate() } }
+        }
+    }
+
+    KeyPairPool(KeyPoolConfig(capacity = count + warmup, refillThreads = Runtime.getRuntime().availableProcessors()))
+        .use { pool ->
+            val service = CertificateSigningService(pool)
+            pool.awaitFull(timeoutMillis = 120_000)
+            report("temporary, pooled keys", count) {
+                repeat(warmup) { service.generateTemporaryCertificate() }
+                measure { repeat(count) { service.generateTemporaryCertificate() } }
+            }
+        }
+
+    val csrs = List(CertificateSigningService.MAX_BATCH_SIZE) { createCSR(it) }
+    KeyPairPool(KeyPoolConfig(capacity = 0)).use { pool ->
+        val service = CertificateSigningService(pool)
+        runBlocking {
+            report("CSR, one at a time", count) {
+                repeat(warmup) { service.signCSR(csrs[it % csrs.size]) }
+                measure { repeat(count) { service.signCSR(csrs[it % csrs.size]) } }
+            }
+            val batches = (count + csrs.size - 1) / csrs.size
+            report("CSR, batches of ${csrs.size}", batches * csrs.size) {
+                repeat((warmup + csrs.size - 1) / csrs.size) { service.signCSRs(csrs) }
+                measure { repeat(batches) { service.signCSRs(csrs) } }
+            }
+        }
+    }
+}
+
+private inline fun measure(block: () -> Unit): Long {
+    val start = System.nanoTime()
+    block()
+    return System.nanoTime() - start
+}
+
+private inline fun report(name: String, count: Int, run: () -> Long) {
+    val nanos = run()
+    val perSecond = count / (nanos / 1e9)
+    println("%-28s %10.0f certs/s %8.3f ms/cert".format(name, perSecond, nanos / 1e6 / count))
+}
+
+private fun createCSR(index: Int): String {
+    val keyPair = KeyPairGenerator.getInstance("EC", "BC")
+        .apply { initialize(ECGenParameterSpec("secp256r1")) }
+        .generateKeyPair()
+    val csr = JcaPKCS10CertificationRequestBuilder(X500Name("CN=Benchmark Device $index, O=C2PA Test"), keyPair.public)
+        .build(JcaContentSignerBuilder("SHA256withECDSA").setProvider("BC").build(keyPair.private))
+    val writer = StringWriter()
+    PemWriter(writer).use { it.writeObject(PemObject("CERTIFICATE REQUEST", csr.encoded)) }
+    return writer.toString()
+}
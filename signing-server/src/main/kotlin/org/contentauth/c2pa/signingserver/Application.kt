@@ -29,19 +29,26 @@ import io.ktor.server.routing.post
 import io.ktor.server.routing.route
 import io.ktor.server.routing.routing
 import kotlinx.serialization.json.Json
+import org.contentauth.c2pa.signingserver.config.KeyPoolConfig
+import org.contentauth.c2pa.signingserver.config.ServerConfig
+import org.contentauth.c2pa.signingserver.config.WorkerPoolConfig
 import org.contentauth.c2pa.signingserver.controllers.C2PAConfigurationController
 import org.contentauth.c2pa.signingserver.controllers.C2PASigningController
 import org.contentauth.c2pa.signingserver.controllers.CertificateSigningController
 import org.contentauth.c2pa.signingserver.services.CertificateSigningService
+import org.contentauth.c2pa.signingserver.services.KeyPairPool
+import org.contentauth.c2pa.signingserver.services.SigningWorkerPool
 
 fun main() {
-    val certificateSigningService = CertificateSigningService()
+    val serverConfig = ServerConfig.fromEnvironment()
+    val certificateSigningService = CertificateSigningService(KeyPairPool(KeyPoolConfig.fromEnvironment()))
+    val signingWorkerPool = SigningWorkerPool(WorkerPoolConfig.fromEnvironment())
 
-    val c2paSigningController = C2PASigningController()
+    val c2paSigningController = C2PASigningController(signingWorkerPool)
     val c2paConfigurationController = C2PAConfigurationController()
     val certificateSigningController = CertificateSigningController(certificateSigningService)
 
-    embeddedServer(Netty, port = 8080, host = "0.0.0.0") {
+    embeddedServer(Netty, port = serverConfig.port, host = serverConfig.host) {
         install(ContentNegotiation) {
             json(
                 Json {
@@ -87,6 +94,7 @@ fun main() {
                 // Certificate signing endpoint
                 route("/certificates") {
                     post("/sign") { certificateSigningController.signCSR(call) }
+                    post("/sign/batch") { certificateSigningController.signCSRBatch(call) }
                 }
 
                 // C2PA endpoints with bearer auth protection
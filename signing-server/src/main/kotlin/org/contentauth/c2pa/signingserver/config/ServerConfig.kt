@@ -16,7 +16,14 @@ data class ServerConfig(
     val port: Int = 8080,
     val host: String = "0.0.0.0",
     val maxRequestSize: Long = 52428800L, // 50MB
-)
+) {
+    companion object {
+        /** Reads overrides from `PORT`. */
+        fun fromEnvironment(): ServerConfig = ServerConfig(
+            port = System.getenv("PORT")?.toIntOrNull() ?: 8080,
+        )
+    }
+}
 
 data class CertificateConfig(
     val rootCAValidityDays: Int = 3650, // 10 years
@@ -24,3 +31,35 @@ data class CertificateConfig(
     val endEntityValidityDays: Int = 365, // 1 year
     val tempCertValidityDays: Int = 1, // 1 day
 )
+
+data class WorkerPoolConfig(
+    val workers: Int = Runtime.getRuntime().availableProcessors(),
+    val queueCapacity: Int = workers * 16,
+    val deadlineMillis: Long = 2_000,
+) {
+    companion object {
+        /** Reads overrides from `SIGNING_WORKERS`, `SIGNING_QUEUE_CAPACITY` and `SIGNING_DEADLINE_MS`. */
+        fun fromEnvironment(): WorkerPoolConfig {
+            val workers = System.getenv("SIGNING_WORKERS")?.toIntOrNull()
+                ?: Runtime.getRuntime().availableProcessors()
+            return WorkerPoolConfig(
+                workers = workers,
+                queueCapacity = System.getenv("SIGNING_QUEUE_CAPACITY")?.toIntOrNull() ?: workers * 16,
+                deadlineMillis = System.getenv("SIGNING_DEADLINE_MS")?.toLongOrNull() ?: 2_000,
+            )
+        }
+    }
+}
+
+data class KeyPoolConfig(
+    val capacity: Int = 256,
+    val refillThreads: Int = 1,
+) {
+    companion object {
+        /** Reads overrides from `KEY_POOL_CAPACITY` and `KEY_POOL_REFILL_THREADS`. */
+        fun fromEnvironment(): KeyPoolConfig = KeyPoolConfig(
+            capacity = System.getenv("KEY_POOL_CAPACITY")?.toIntOrNull() ?: 256,
+            refillThreads = System.getenv("KEY_POOL_REFILL_THREADS")?.toIntOrNull() ?: 1,
+        )
+    }
+}
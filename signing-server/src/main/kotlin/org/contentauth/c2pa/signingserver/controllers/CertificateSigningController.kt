@@ -17,6 +17,8 @@ import io.ktor.server.application.ApplicationCall
 import io.ktor.server.application.log
 import io.ktor.server.request.receive
 import io.ktor.server.response.respond
+import org.contentauth.c2pa.signingserver.models.BatchCertificateSigningRequest
+import org.contentauth.c2pa.signingserver.models.BatchCertificateSigningResponse
 import org.contentauth.c2pa.signingserver.models.CertificateSigningRequest
 import org.contentauth.c2pa.signingserver.services.CertificateSigningService
 
@@ -49,4 +51,31 @@ class CertificateSigningController(private val certificateService: CertificateSi
             )
         }
     }
+
+    suspend fun signCSRBatch(call: ApplicationCall) {
+        try {
+            val batchRequest = call.receive<BatchCertificateSigningRequest>()
+
+            if (batchRequest.csrs.isEmpty() || batchRequest.csrs.size > CertificateSigningService.MAX_BATCH_SIZE) {
+                call.respond(
+                    HttpStatusCode.BadRequest,
+                    mapOf("error" to "Batch must contain 1 to ${CertificateSigningService.MAX_BATCH_SIZE} CSRs"),
+                )
+                return
+            }
+
+            val results = certificateService.signCSRs(batchRequest.csrs)
+
+            val issued = results.count { it.certificate != null }
+            call.application.log.info("Issued $issued of ${results.size} certificates in batch")
+
+            call.respond(HttpStatusCode.OK, BatchCertificateSigningResponse(results))
+        } catch (e: Exception) {
+            call.application.log.error("Error signing CSR batch", e)
+            call.respond(
+                HttpStatusCode.InternalServerError,
+                mapOf("error" to (e.message ?: "Failed to sign CSR batch")),
+            )
+        }
+    }
 }
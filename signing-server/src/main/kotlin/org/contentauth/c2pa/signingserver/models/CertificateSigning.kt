@@ -31,3 +31,22 @@ data class SignedCertificateSigningResponse(
     @SerialName("expires_at") @Contextual val expiresAt: Instant,
     @SerialName("serial_number") val serialNumber: String,
 )
+
+/** Request payload containing several PEM-encoded certificate signing requests. */
+@Serializable
+data class BatchCertificateSigningRequest(
+    val csrs: List<String>,
+)
+
+/** Outcome for one CSR in a batch: either a certificate or an error. */
+@Serializable
+data class BatchCertificateSigningResult(
+    val certificate: SignedCertificateSigningResponse? = null,
+    val error: String? = null,
+)
+
+/** Response payload for a batch, with one result per CSR in request order. */
+@Serializable
+data class BatchCertificateSigningResponse(
+    val results: List<BatchCertificateSigningResult>,
+)
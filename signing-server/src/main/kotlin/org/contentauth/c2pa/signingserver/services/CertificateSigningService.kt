@@ -12,8 +12,13 @@ each license.
 
 package org.contentauth.c2pa.signingserver.services
 
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
 import kotlinx.datetime.Instant
 import org.bouncycastle.asn1.x500.X500Name
+import org.bouncycastle.asn1.x509.AuthorityKeyIdentifier
 import org.bouncycastle.asn1.x509.BasicConstraints
 import org.bouncycastle.asn1.x509.ExtendedKeyUsage
 import org.bouncycastle.asn1.x509.Extension
@@ -24,11 +29,13 @@ import org.bouncycastle.cert.X509v3CertificateBuilder
 import org.bouncycastle.cert.jcajce.JcaX509CertificateConverter
 import org.bouncycastle.cert.jcajce.JcaX509ExtensionUtils
 import org.bouncycastle.jce.provider.BouncyCastleProvider
+import org.bouncycastle.operator.ContentSigner
 import org.bouncycastle.operator.jcajce.JcaContentSignerBuilder
 import org.bouncycastle.pkcs.PKCS10CertificationRequest
 import org.bouncycastle.util.io.pem.PemObject
 import org.bouncycastle.util.io.pem.PemReader
 import org.bouncycastle.util.io.pem.PemWriter
+import org.contentauth.c2pa.signingserver.models.BatchCertificateSigningResult
 import org.contentauth.c2pa.signingserver.models.SignedCertificateSigningResponse
 import java.io.StringReader
 import java.io.StringWriter
@@ -38,18 +45,43 @@ import java.security.KeyPair
 import java.security.KeyPairGenerator
 import java.security.PrivateKey
 import java.security.PublicKey
+import java.security.SecureRandom
 import java.security.Security
 import java.security.cert.X509Certificate
 import java.security.spec.ECGenParameterSpec
+import java.security.spec.X509EncodedKeySpec
 import java.util.Date
 import java.util.UUID
 
-class CertificateSigningService {
+/**
+ * Issues end-entity certificates from a test CA hierarchy.
+ *
+ * Everything that is the same for every certificate is prepared once: the issuer name, the
+ * authority key identifier, the PEM of the CA part of the chain, and, per thread, the
+ * [ContentSigner] for the intermediate CA key. Temporary certificates take their key pairs from
+ * [keyPool] so that key generation happens in the background rather than per request.
+ */
+class CertificateSigningService(private val keyPool: KeyPairPool = KeyPairPool()) {
     private val rootCA: X509Certificate
     private val rootCAPrivateKey: PrivateKey
     private val intermediateCA: X509Certificate
     private val intermediateCAPrivateKey: PrivateKey
 
+    private val intermediateIssuer: X500Name
+    private val intermediateAuthorityKeyId: AuthorityKeyIdentifier
+    private val caChainPEM: String
+
+    // ContentSigner buffers the data being signed, so each thread needs its own
+    private val intermediateSigner = ThreadLocal.withInitial { contentSigner(intermediateCAPrivateKey) }
+    private val keyFactory = ThreadLocal.withInitial { KeyFactory.getInstance("EC", "BC") }
+    private val extensionUtils = ThreadLocal.withInitial { JcaX509ExtensionUtils() }
+    private val serialRandom = SecureRandom()
+
+    companion object {
+        /** Maximum number of CSRs accepted in one batch. */
+        const val MAX_BATCH_SIZE = 100
+    }
+
     init {
         Security.addProvider(BouncyCastleProvider())
 
@@ -66,7 +98,8 @@ class CertificateSigningService {
                 subject = rootSubject,
                 issuer = rootSubject,
                 publicKey = rootKeyPair.public,
-                signerKey = rootCAPrivateKey,
+                signer = contentSigner(rootCAPrivateKey),
+                authorityKeyId = null,
                 isCA = true,
                 pathLenConstraint = 1,
                 validityDays = 3650, // 10 years
@@ -85,11 +118,20 @@ class CertificateSigningService {
                 subject = intermediateSubject,
                 issuer = X500Name(rootCA.subjectX500Principal.name),
                 publicKey = intermediateKeyPair.public,
-                signerKey = rootCAPrivateKey,
+                signer = contentSigner(rootCAPrivateKey),
+                authorityKeyId = JcaX509ExtensionUtils().createAuthorityKeyIdentifier(rootCA),
                 isCA = true,
                 pathLenConstraint = 0,
                 validityDays = 1825, // 5 years
             )
+
+        intermediateIssuer = X500Name(intermediateCA.subjectX500Principal.name)
+        intermediateAuthorityKeyId = JcaX509ExtensionUtils().createAuthorityKeyIdentifier(intermediateCA)
+        caChainPEM = buildString {
+            append(certificateToPEM(intermediateCA))
+            append("\n")
+            append(certificateToPEM(rootCA))
+        }
     }
 
     suspend fun signCSR(csrPEM: String): SignedCertificateSigningResponse {
@@ -101,25 +143,10 @@ class CertificateSigningService {
         val subject = csr.subject
 
         // Generate end-entity certificate
-        val certificate =
-            generateCertificate(
-                subject = subject,
-                issuer = X500Name(intermediateCA.subjectX500Principal.name),
-                publicKey = publicKey,
-                signerKey = intermediateCAPrivateKey,
-                isCA = false,
-                pathLenConstraint = null,
-                validityDays = 365, // 1 year
-            )
+        val certificate = issueEndEntity(subject, publicKey, validityDays = 365) // 1 year
 
         // Create certificate chain
-        val certificateChain = buildString {
-            append(certificateToPEM(certificate))
-            append("\n")
-            append(certificateToPEM(intermediateCA))
-            append("\n")
-            append(certificateToPEM(rootCA))
-        }
+        val certificateChain = chainPEM(certificate)
 
         val certificateId = UUID.randomUUID().toString()
         val expiresAt = Instant.fromEpochMilliseconds(certificate.notAfter.time)
@@ -132,35 +159,61 @@ class CertificateSigningService {
         )
     }
 
+    /**
+     * Signs several CSRs at once, spreading the work over the available cores. A CSR that cannot
+     * be signed produces an error entry; it does not fail the rest of the batch.
+     */
+    suspend fun signCSRs(csrPEMs: List<String>): List<BatchCertificateSigningResult> {
+        require(csrPEMs.size <= MAX_BATCH_SIZE) { "At most $MAX_BATCH_SIZE CSRs per batch" }
+        return coroutineScope {
+            csrPEMs.map { csrPEM ->
+                async(Dispatchers.Default) {
+                    try {
+                        BatchCertificateSigningResult(certificate = signCSR(csrPEM))
+                    } catch (e: Exception) {
+                        BatchCertificateSigningResult(error = e.message ?: "Failed to sign CSR")
+                    }
+                }
+            }.awaitAll()
+        }
+    }
+
     fun generateTemporaryCertificate(): Pair<String, PrivateKey> {
-        val keyPair = generateKeyPair()
+        val keyPair = keyPool.take()
 
         val subject =
             X500Name(
                 "CN=Temporary C2PA Signer, O=Temporary Certificate, OU=FOR TESTING ONLY, C=US",
             )
-        val certificate =
-            generateCertificate(
-                subject = subject,
-                issuer = X500Name(intermediateCA.subjectX500Principal.name),
-                publicKey = keyPair.public,
-                signerKey = intermediateCAPrivateKey,
-                isCA = false,
-                pathLenConstraint = null,
-                validityDays = 1, // 1 day
-            )
+        val certificate = issueEndEntity(subject, keyPair.public, validityDays = 1) // 1 day
 
-        val certificateChain = buildString {
-            append(certificateToPEM(certificate))
-            append("\n")
-            append(certificateToPEM(intermediateCA))
-            append("\n")
-            append(certificateToPEM(rootCA))
-        }
+        return chainPEM(certificate) to keyPair.private
+    }
+
+    /** Returns key pool activity, for monitoring. */
+    fun keyPoolStats(): KeyPairPool.Stats = keyPool.stats()
+
+    private fun issueEndEntity(subject: X500Name, publicKey: PublicKey, validityDays: Int): X509Certificate =
+        generateCertificate(
+            subject = subject,
+            issuer = intermediateIssuer,
+            publicKey = publicKey,
+            signer = intermediateSigner.get(),
+            authorityKeyId = intermediateAuthorityKeyId,
+            isCA = false,
+            pathLenConstraint = null,
+            validityDays = validityDays,
+        )
 
-        return certificateChain to keyPair.private
+    private fun chainPEM(certificate: X509Certificate): String = buildString {
+        append(certificateToPEM(certificate))
+        append("\n")
+        append(caChainPEM)
     }
 
+    private fun contentSigner(key: PrivateKey): ContentSigner =
+        JcaContentSignerBuilder("SHA256withECDSA").setProvider("BC").build(key)
+
     private fun generateKeyPair(): KeyPair {
         val keyGen = KeyPairGenerator.getInstance("EC", "BC")
         keyGen.initialize(ECGenParameterSpec("secp256r1"))
@@ -171,7 +224,8 @@ class CertificateSigningService {
         subject: X500Name,
         issuer: X500Name,
         publicKey: PublicKey,
-        signerKey: PrivateKey,
+        signer: ContentSigner,
+        authorityKeyId: AuthorityKeyIdentifier?,
         isCA: Boolean,
         pathLenConstraint: Int?,
         validityDays: Int,
@@ -180,7 +234,8 @@ class CertificateSigningService {
         val notBefore = Date(now.time - 300000) // 5 minutes ago to avoid clock skew issues
         val notAfter = Date(now.time + validityDays * 24L * 60 * 60 * 1000)
 
-        val serialNumber = BigInteger.valueOf(System.currentTimeMillis())
+        // Random rather than time-based, so certificates issued in the same millisecond differ
+        val serialNumber = BigInteger(64, serialRandom)
 
         val certBuilder =
             X509v3CertificateBuilder(
@@ -193,7 +248,7 @@ class CertificateSigningService {
             )
 
         // Add extensions
-        val extUtils = JcaX509ExtensionUtils()
+        val extUtils = extensionUtils.get()
 
         // Subject Key Identifier
         certBuilder.addExtension(
@@ -203,11 +258,11 @@ class CertificateSigningService {
         )
 
         // Authority Key Identifier (if not self-signed)
-        if (issuer != subject) {
+        if (authorityKeyId != null) {
             certBuilder.addExtension(
                 Extension.authorityKeyIdentifier,
                 false,
-                extUtils.createAuthorityKeyIdentifier(publicKey),
+                authorityKeyId,
             )
         }
 
@@ -245,10 +300,7 @@ class CertificateSigningService {
             )
         }
 
-        val contentSigner =
-            JcaContentSignerBuilder("SHA256withECDSA").setProvider("BC").build(signerKey)
-
-        val certHolder = certBuilder.build(contentSigner)
+        val certHolder = certBuilder.build(signer)
 
         return JcaX509CertificateConverter().setProvider("BC").getCertificate(certHolder)
     }
@@ -264,12 +316,8 @@ class CertificateSigningService {
     }
 
     private fun getPublicKeyFromCSR(csr: PKCS10CertificationRequest): PublicKey {
-        val keyFactory = KeyFactory.getInstance("EC", "BC")
-        val keySpec =
-            java.security.spec.X509EncodedKeySpec(
-                csr.subjectPublicKeyInfo.encoded,
-            )
-        return keyFactory.generatePublic(keySpec)
+        val keySpec = X509EncodedKeySpec(csr.subjectPublicKeyInfo.encoded)
+        return keyFactory.get().generatePublic(keySpec)
     }
 
     private fun certificateToPEM(certificate: X509Certificate): String {
@@ -0,0 +1,109 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.signingserver.services
+
+import org.bouncycastle.jce.provider.BouncyCastleProvider
+import org.contentauth.c2pa.signingserver.config.KeyPoolConfig
+import java.io.Closeable
+import java.security.KeyPair
+import java.security.KeyPairGenerator
+import java.security.Security
+import java.security.spec.ECGenParameterSpec
+import java.util.concurrent.ArrayBlockingQueue
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Keeps a stock of pre-generated P-256 key pairs so that issuing a certificate does not wait for
+ * key generation.
+ *
+ * Background threads keep the pool full. When a burst drains it, [take] generates a key pair
+ * inline, so callers are never blocked on the refill threads; the pool only moves key generation
+ * off the request path while there is stock. A capacity of 0 disables pre-generation.
+ */
+class KeyPairPool(private val config: KeyPoolConfig = KeyPoolConfig()) : Closeable {
+
+    /**
+     * A snapshot of pool activity.
+     *
+     * @property available Key pairs ready to hand out
+     * @property hits Requests served from the pool
+     * @property misses Requests that generated a key pair inline because the pool was empty
+     */
+    data class Stats(val available: Int, val hits: Long, val misses: Long)
+
+    private val pool = ArrayBlockingQueue<KeyPair>(config.capacity.coerceAtLeast(1))
+    private val hits = AtomicLong()
+    private val misses = AtomicLong()
+
+    init {
+        // The refill threads may start before anything else has registered BouncyCastle
+        Security.addProvider(BouncyCastleProvider())
+    }
+
+    private val generator = ThreadLocal.withInitial {
+        KeyPairGenerator.getInstance("EC", "BC").apply { initialize(ECGenParameterSpec("secp256r1")) }
+    }
+
+    private val refillThreads: List<Thread> =
+        if (config.capacity <= 0) {
+            emptyList()
+        } else {
+            List(config.refillThreads.coerceAtLeast(1)) { index ->
+                Thread({ refill() }, "key-pool-refill-${index + 1}").apply {
+                    isDaemon = true
+                    priority = Thread.MIN_PRIORITY
+                    start()
+                }
+            }
+        }
+
+    /** Returns a fresh key pair. Each key pair is handed out once. */
+    fun take(): KeyPair {
+        pool.poll()?.let {
+            hits.incrementAndGet()
+            return it
+        }
+        misses.incrementAndGet()
+        return generate()
+    }
+
+    /** Returns current stock and cumulative counters. */
+    fun stats(): Stats = Stats(if (config.capacity <= 0) 0 else pool.size, hits.get(), misses.get())
+
+    /** Blocks until the pool is full, or [timeoutMillis] passes. Returns whether it filled. */
+    fun awaitFull(timeoutMillis: Long): Boolean {
+        if (config.capacity <= 0) return true
+        val deadline = System.currentTimeMillis() + timeoutMillis
+        while (pool.remainingCapacity() > 0) {
+            if (System.currentTimeMillis() >= deadline) return false
+            Thread.sleep(10)
+        }
+        return true
+    }
+
+    private fun generate(): KeyPair = generator.get().generateKeyPair()
+
+    private fun refill() {
+        try {
+            while (!Thread.currentThread().isInterrupted) {
+                pool.put(generate())
+            }
+        } catch (e: InterruptedException) {
+            // Closed
+        }
+    }
+
+    override fun close() {
+        refillThreads.forEach { it.interrupt() }
+    }
+}
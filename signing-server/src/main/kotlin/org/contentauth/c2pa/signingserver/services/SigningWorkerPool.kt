@@ -0,0 +1,131 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.signingserver.services
+
+import kotlinx.coroutines.TimeoutCancellationException
+import kotlinx.coroutines.future.await
+import kotlinx.coroutines.withTimeout
+import org.contentauth.c2pa.signingserver.config.WorkerPoolConfig
+import java.io.Closeable
+import java.util.concurrent.ArrayBlockingQueue
+import java.util.concurrent.CompletableFuture
+import java.util.concurrent.RejectedExecutionException
+import java.util.concurrent.Semaphore
+import java.util.concurrent.ThreadPoolExecutor
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+import kotlin.math.ceil
+
+/**
+ * Runs CPU-bound crypto work on a fixed pool of worker threads, off the request-handling event
+ * loop.
+ *
+ * At most `workers + queueCapacity` jobs are admitted at once, and the executor queue is bounded
+ * to `queueCapacity`. Further jobs are refused with [Saturated], which carries a retry hint
+ * derived from the current backlog, so callers can answer 429 immediately instead of letting
+ * every request's latency grow.
+ *
+ * Each job has a deadline. A job whose deadline has passed by the time a worker picks it up is
+ * dropped without running. A job that has started cannot be interrupted: its caller gets
+ * [DeadlineExceeded] when the deadline passes, but the job runs to completion on its worker and
+ * keeps its admission slot until then, so timed-out work still counts against capacity.
+ */
+class SigningWorkerPool(private val config: WorkerPoolConfig = WorkerPoolConfig()) : Closeable {
+
+    /** Thrown when the pool cannot admit another job. */
+    class Saturated(val retryAfterSeconds: Long) : Exception("Signing workers saturated")
+
+    /** Thrown when a job does not complete within its deadline. */
+    class DeadlineExceeded(val deadlineMillis: Long) : Exception("Signing deadline of $deadlineMillis ms exceeded")
+
+    private val threadIndex = AtomicInteger()
+    private val executor =
+        ThreadPoolExecutor(
+            config.workers,
+            config.workers,
+            0L,
+            TimeUnit.MILLISECONDS,
+            ArrayBlockingQueue(config.queueCapacity.coerceAtLeast(1)),
+        ) { runnable ->
+            Thread(runnable, "signing-worker-${threadIndex.incrementAndGet()}").apply { isDaemon = true }
+        }
+    private val admission = Semaphore(config.workers + config.queueCapacity)
+
+    private val inFlight = AtomicInteger()
+    private val completed = AtomicLong()
+    private val serviceNanos = AtomicLong()
+
+    /** Number of admitted jobs, running or queued, including ones whose caller has timed out. */
+    val pending: Int get() = inFlight.get()
+
+    /**
+     * Runs [block] on a worker thread.
+     *
+     * @throws Saturated if the queue is full
+     * @throws DeadlineExceeded if [block] has not completed within the configured deadline
+     */
+    suspend fun <T> submit(block: () -> T): T {
+        if (!admission.tryAcquire()) {
+            throw Saturated(retryAfterSeconds())
+        }
+        inFlight.incrementAndGet()
+        val deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(config.deadlineMillis)
+        val result = CompletableFuture<T>()
+        val job = Runnable {
+            try {
+                val start = System.nanoTime()
+                if (result.isCancelled || start - deadline >= 0) {
+                    // The caller has already given up; don't start the sign
+                    result.completeExceptionally(DeadlineExceeded(config.deadlineMillis))
+                } else {
+                    val value = block()
+                    serviceNanos.addAndGet(System.nanoTime() - start)
+                    completed.incrementAndGet()
+                    result.complete(value)
+                }
+            } catch (e: Throwable) {
+                result.completeExceptionally(e)
+            } finally {
+                // The slot is held until the work is really done, not until the caller gives up
+                inFlight.decrementAndGet()
+                admission.release()
+            }
+        }
+        try {
+            executor.execute(job)
+        } catch (e: RejectedExecutionException) {
+            inFlight.decrementAndGet()
+            admission.release()
+            throw Saturated(retryAfterSeconds())
+        }
+        val remainingMillis = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime()).coerceAtLeast(1)
+        try {
+            return withTimeout(remainingMillis) { result.await() }
+        } catch (e: TimeoutCancellationException) {
+            throw DeadlineExceeded(config.deadlineMillis)
+        }
+    }
+
+    /** Estimates how long the current backlog takes to drain, rounded up to whole seconds. */
+    private fun retryAfterSeconds(): Long {
+        val done = completed.get()
+        val averageMillis = if (done == 0L) 1.0 else serviceNanos.get() / 1e6 / done
+        val drainMillis = averageMillis * inFlight.get() / config.workers
+        return ceil(drainMillis / 1000).toLong().coerceAtLeast(1)
+    }
+
+    override fun close() {
+        executor.shutdown()
+    }
+}
@@ -171,6 +171,10 @@ private suspend fun runAllTests(context: Context): List<TestResult> = withContex
     results.add(coreTests.testErrorEnumCoverage())
     results.add(coreTests.testReaderDetailedJson())
     results.add(coreTests.testReaderIsEmbedded())
+    results.add(coreTests.testVerificationLevels())
+    results.add(coreTests.testLazyIngredientValidation())
+    results.add(coreTests.testSignatureVerificationCache())
+    results.add(coreTests.testRevocationIndex())
 
     // Stream Tests
     val streamTests = AppStreamTests(context)
@@ -190,8 +194,14 @@ private suspend fun runAllTests(context: Context): List<TestResult> = withContex
     results.add(builderTests.testBuilderFromArchive())
     results.add(builderTests.testReaderWithManifestData())
     results.add(builderTests.testJsonRoundTrip())
+    results.add(builderTests.testCborRoundTrip())
     results.add(builderTests.testBuilderSetIntent())
     results.add(builderTests.testBuilderAddAction())
+    results.add(builderTests.testSharedContextUpdate())
+    results.add(builderTests.testParsedManifestStore())
+    results.add(builderTests.testIncrementalResign())
+    results.add(builderTests.testCollectionSigning())
+    results.add(builderTests.testBoxHashSigning())
 
     // Signer Tests
     val signerTests = AppSignerTests(context)
@@ -208,11 +218,19 @@ private suspend fun runAllTests(context: Context): List<TestResult> = withContex
     results.add(signerTests.testStrongBoxAvailability())
     results.add(signerTests.testSignerFromSettingsToml())
     results.add(signerTests.testSignerFromSettingsJson())
+    results.add(signerTests.testSignerFromContext())
+    results.add(signerTests.testEd25519KeyBatch())
+    results.add(signerTests.testKeyStoreSigningPipeline())
+    results.add(signerTests.testSignerPool())
+    results.add(signerTests.testCertificateLifecycleManager())
+    results.add(signerTests.testAdaptiveReserveSize())
+    results.add(signerTests.testBatchSignerPipelinedTimestamps())
 
     // Web Service Tests (if server is available)
     val webServiceTests = AppWebServiceTests(context)
     results.add(webServiceTests.testWebServiceSigningAndVerification())
     results.add(webServiceTests.testWebServiceSignerCreation())
+    results.add(webServiceTests.testHedgedWebServiceSigning())
     results.add(webServiceTests.testCSRSigning())
 
     // Additional Core Tests (concurrency, resource error handling)
@@ -223,6 +241,7 @@ private suspend fun runAllTests(context: Context): List<TestResult> = withContex
     results.add(streamTests.testCallbackStreamFactories())
     results.add(streamTests.testByteArrayStreamBufferGrowth())
     results.add(streamTests.testLargeBufferHandling())
+    results.add(streamTests.testHttpRangeStream())
 
     // Manifest Tests
     val manifestTests = AppManifestTests(context)
@@ -250,6 +269,8 @@ private suspend fun runAllTests(context: Context): List<TestResult> = withContex
     results.add(manifestTests.testCustomAssertionLabelValidation())
     results.add(manifestTests.testImageRegionTypeToTypeString())
     results.add(manifestTests.testStandardAssertionLabelSerialNames())
+    results.add(manifestTests.testManifestStoreView())
+    results.add(manifestTests.testManifestValidatorBatch())
 
     // Settings Definition Tests
     val settingsDefinitionTests = AppSettingsDefinitionTests(context)
@@ -65,4 +65,8 @@ dependencies {
 
     // OkHttp for web service tests
     implementation("com.squareup.okhttp3:okhttp:5.1.0")
+
+    // BouncyCastle for the local time stamp authority
+    implementation("org.bouncycastle:bcprov-jdk18on:1.81")
+    implementation("org.bouncycastle:bcpkix-jdk18on:1.81")
 }
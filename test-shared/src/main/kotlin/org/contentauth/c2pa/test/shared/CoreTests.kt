@@ -17,17 +17,40 @@ import kotlinx.coroutines.async
 import kotlinx.coroutines.awaitAll
 import kotlinx.coroutines.coroutineScope
 import kotlinx.coroutines.withContext
+import org.bouncycastle.asn1.x500.X500Name
+import org.bouncycastle.asn1.x509.CRLNumber
+import org.bouncycastle.asn1.x509.CRLReason
+import org.bouncycastle.asn1.x509.Extension
+import org.bouncycastle.cert.X509v2CRLBuilder
+import org.bouncycastle.cert.jcajce.JcaX509CertificateConverter
+import org.bouncycastle.cert.jcajce.JcaX509v3CertificateBuilder
+import org.bouncycastle.operator.jcajce.JcaContentSignerBuilder
 import org.contentauth.c2pa.Builder
 import org.contentauth.c2pa.ByteArrayStream
 import org.contentauth.c2pa.C2PA
+import org.contentauth.c2pa.C2PAContext
 import org.contentauth.c2pa.C2PAError
+import org.contentauth.c2pa.C2PASettings
+import org.contentauth.c2pa.DataStream
 import org.contentauth.c2pa.Reader
+import org.contentauth.c2pa.RevocationCheck
+import org.contentauth.c2pa.RevocationIndex
+import org.contentauth.c2pa.RevocationStatus
+import org.contentauth.c2pa.SignatureVerificationCache
 import org.contentauth.c2pa.Signer
 import org.contentauth.c2pa.SignerInfo
 import org.contentauth.c2pa.SigningAlgorithm
+import org.contentauth.c2pa.VerificationLevel
 import org.json.JSONArray
 import org.json.JSONObject
 import java.io.File
+import java.math.BigInteger
+import java.security.KeyPairGenerator
+import java.security.PrivateKey
+import java.security.cert.CertificateFactory
+import java.security.cert.X509Certificate
+import java.security.spec.ECGenParameterSpec
+import java.util.Date
 
 /** CoreTests - Core library functionality tests */
 abstract class CoreTests : TestBase() {
@@ -745,4 +768,353 @@ abstract class CoreTests : TestBase() {
             }
         }
     }
+
+    suspend fun testVerificationLevels(): TestResult = withContext(Dispatchers.IO) {
+        runTest("Verification Levels") {
+            val certPem = loadResourceAsString("es256_certs")
+            val keyPem = loadResourceAsString("es256_private")
+            val signed = try {
+                Signer.fromInfo(SignerInfo(SigningAlgorithm.ES256, certPem, keyPem)).use { signer ->
+                    Builder.fromJson(TEST_MANIFEST_JSON).use { builder ->
+                        DataStream(loadResourceAsBytes("pexels_asadphoto_457882")).use { source ->
+                            ByteArrayStream().use { dest ->
+                                builder.sign("image/jpeg", source, dest, signer)
+                                dest.getData()
+                            }
+                        }
+                    }
+                }
+            } catch (e: C2PAError) {
+                return@runTest TestResult("Verification Levels", false, "Failed to sign test image", e.toString())
+            }
+
+            // Alter pixel data near the end: the signature still verifies, the hard binding does not
+            val tampered = signed.copyOf().also { bytes ->
+                // Avoid creating or breaking a JPEG marker in the entropy-coded data
+                var index = bytes.size - 100
+                while (bytes[index].toInt() and 0xFE == 0xFE || bytes[index - 1] == 0xFF.toByte()) index--
+                bytes[index] = (bytes[index].toInt() xor 0x01).toByte()
+            }
+
+            // Alter a byte of the claim itself: the signature over it must no longer verify
+            val corruptedClaim = signed.copyOf().also { bytes ->
+                // The claim's "signature" field is the only place the URI form appears
+                val marker = "/c2pa.signature".toByteArray()
+                val at = (0..bytes.size - marker.size).first { i ->
+                    marker.indices.all { bytes[i + it] == marker[it] }
+                }
+                // Replace a letter with another letter so the claim stays well-formed CBOR
+                bytes[at + 1] = 'C'.code.toByte()
+            }
+
+            try {
+                val structureOnly = DataStream(signed).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.STRUCTURE_ONLY).use { reader ->
+                        reader.verificationLevel == VerificationLevel.STRUCTURE_ONLY &&
+                            reader.integrityCheck == null &&
+                            JSONObject(reader.json()).has("active_manifest")
+                    }
+                }
+
+                val signatureValid = DataStream(signed).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.SIGNATURE_ONLY).use { reader ->
+                        reader.integrityCheck
+                    }
+                }
+
+                val (tamperedSignature, upgradedJson, upgradedLevel) = DataStream(tampered).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.SIGNATURE_ONLY).use { reader ->
+                        val check = reader.integrityCheck
+                        reader.upgrade()
+                        // A FULL reader reports only native validation results
+                        Triple(check?.takeIf { reader.integrityCheck == null }, reader.json(), reader.verificationLevel)
+                    }
+                }
+
+                val corruptedSignature = DataStream(corruptedClaim).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.SIGNATURE_ONLY).use { reader ->
+                        reader.integrityCheck
+                    }
+                }
+
+                val success = structureOnly &&
+                    signatureValid?.intact == true && signatureValid.algorithm == "ES256" &&
+                    tamperedSignature?.intact == true &&
+                    corruptedSignature?.intact == false &&
+                    upgradedLevel == VerificationLevel.FULL && upgradedJson.contains("dataHash.mismatch")
+                TestResult(
+                    "Verification Levels",
+                    success,
+                    if (success) {
+                        "Levels skip hashing and upgrade() completes full validation"
+                    } else {
+                        "Verification levels did not behave as expected"
+                    },
+                    "Structure only: $structureOnly, signature: $signatureValid, " +
+                        "tampered signature: $tamperedSignature, corrupted claim: $corruptedSignature, " +
+                        "upgraded to $upgradedLevel, " +
+                        "hash mismatch reported: ${upgradedJson.contains("dataHash.mismatch")}",
+                )
+            } catch (e: C2PAError) {
+                TestResult("Verification Levels", false, "Failed to read at a verification level", e.toString())
+            }
+        }
+    }
+
+    suspend fun testLazyIngredientValidation(): TestResult = withContext(Dispatchers.IO) {
+        runTest("Lazy Ingredient Validation") {
+            val certPem = loadResourceAsString("es256_certs")
+            val keyPem = loadResourceAsString("es256_private")
+            val imageData = loadResourceAsBytes("pexels_asadphoto_457882")
+
+            try {
+                val composite = Signer.fromInfo(SignerInfo(SigningAlgorithm.ES256, certPem, keyPem)).use { signer ->
+                    fun sign(builder: Builder): ByteArray = DataStream(imageData).use { source ->
+                        ByteArrayStream().use { dest ->
+                            builder.sign("image/jpeg", source, dest, signer)
+                            dest.getData()
+                        }
+                    }
+
+                    val parents = List(3) { Builder.fromJson(TEST_MANIFEST_JSON).use { sign(it) } }
+                    Builder.fromJson(TEST_MANIFEST_JSON).use { builder ->
+                        parents.forEachIndexed { index, parent ->
+                            DataStream(parent).use { stream ->
+                                builder.addIngredient(
+                                    """{"title": "Parent $index", "relationship": "componentOf"}""",
+                                    "image/jpeg",
+                                    stream,
+                                )
+                            }
+                        }
+                        sign(builder)
+                    }
+                }
+
+                DataStream(composite).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.STRUCTURE_ONLY).use { reader ->
+                        val count = reader.ingredientCount()
+                        val first = reader.ingredient(0)
+                        val all = reader.checkIngredientClaimSignatures(parallelism = 2)
+
+                        val success = count == 3 &&
+                            first.manifestLabel != null && first.integrityCheck?.intact == true &&
+                            all.size == 3 && all.values.all { it.intact } &&
+                            all[first.manifestLabel] == first.integrityCheck
+                        TestResult(
+                            "Lazy Ingredient Validation",
+                            success,
+                            if (success) {
+                                "Ingredient claim signatures checked on demand and in parallel"
+                            } else {
+                                "Ingredient claim checks were unexpected"
+                            },
+                            "Ingredients: $count, first: ${first.title} ${first.integrityCheck}, " +
+                                "checked manifests: ${all.size}, all intact: ${all.values.all { it.intact }}",
+                        )
+                    }
+                }
+            } catch (e: C2PAError) {
+                TestResult("Lazy Ingredient Validation", false, "Failed to build or read composite", e.toString())
+            }
+        }
+    }
+
+    suspend fun testSignatureVerificationCache(): TestResult = withContext(Dispatchers.IO) {
+        runTest("Signature Verification Cache") {
+            val certPem = loadResourceAsString("es256_certs")
+            val keyPem = loadResourceAsString("es256_private")
+            val imageData = loadResourceAsBytes("pexels_asadphoto_457882")
+
+            try {
+                val signed = Signer.fromInfo(SignerInfo(SigningAlgorithm.ES256, certPem, keyPem)).use { signer ->
+                    Builder.fromJson(TEST_MANIFEST_JSON).use { builder ->
+                        DataStream(imageData).use { source ->
+                            ByteArrayStream().use { dest ->
+                                builder.sign("image/jpeg", source, dest, signer)
+                                dest.getData()
+                            }
+                        }
+                    }
+                }
+
+                val cache = SignatureVerificationCache(maxEntries = 8)
+                fun contextWith(settingsJson: String) = C2PASettings.create().use { settings ->
+                    settings.updateFromString(settingsJson, "json")
+                    C2PAContext.fromSettings(settings, signatureCache = cache)
+                }
+                fun check(context: C2PAContext) = DataStream(signed).use { stream ->
+                    Reader.fromStream("image/jpeg", stream, VerificationLevel.SIGNATURE_ONLY, context).use {
+                        it.integrityCheck
+                    }
+                }
+
+                val reads = 4
+                val untrusted = contextWith("""{"version": 1}""")
+                val checks = untrusted.use { context -> List(reads) { check(context) } }
+                val stats = cache.stats()
+
+                // A context with other trust settings sharing the cache is keyed apart from it
+                val trustJson = JSONObject()
+                    .put("version", 1)
+                    .put("trust", JSONObject().put("trust_anchors", certPem))
+                    .toString()
+                val trusted = contextWith(trustJson).use { check(it) }
+                val keyedByTrust = trusted?.intact == true && cache.stats().let { it.misses == 2L && it.size == 2 }
+
+                cache.clear()
+                val cleared = cache.stats()
+
+                val success = checks.all { it?.intact == true } &&
+                    stats.misses == 1L && stats.hits == reads - 1L && stats.size == 1 &&
+                    keyedByTrust && cleared.size == 0
+                TestResult(
+                    "Signature Verification Cache",
+                    success,
+                    if (success) {
+                        "Repeated claim signature checks were served from the cache"
+                    } else {
+                        "Cache activity was unexpected"
+                    },
+                    "Checks: $checks, stats: $stats, keyed by trust: $keyedByTrust, after clear: $cleared",
+                )
+            } catch (e: C2PAError) {
+                TestResult("Signature Verification Cache", false, "Failed to sign or read image", e.toString())
+            }
+        }
+    }
+
+    suspend fun testRevocationIndex(): TestResult = withContext(Dispatchers.IO) {
+        runTest("Revocation Index") {
+            val certPem = loadResourceAsString("es256_certs")
+            val keyPem = loadResourceAsString("es256_private")
+            val imageData = loadResourceAsBytes("pexels_asadphoto_457882")
+            val indexFile = File.createTempFile("revocation", ".idx")
+
+            try {
+                val leaf = CertificateFactory.getInstance("X.509")
+                    .generateCertificates(certPem.byteInputStream()).first() as X509Certificate
+                fun keyPair() = KeyPairGenerator.getInstance("EC")
+                    .apply { initialize(ECGenParameterSpec("secp256r1")) }
+                    .generateKeyPair()
+                val crlKey = keyPair()
+                val issuerName = X500Name.getInstance(leaf.issuerX500Principal.encoded)
+                // A stand-in for the leaf's issuer, holding the key that signs the test CRLs
+                val crlIssuer = JcaX509CertificateConverter().getCertificate(
+                    JcaX509v3CertificateBuilder(
+                        issuerName,
+                        BigInteger.ONE,
+                        Date(System.currentTimeMillis() - 86_400_000L),
+                        Date(System.currentTimeMillis() + 86_400_000L),
+                        issuerName,
+                        crlKey.public,
+                    ).build(JcaContentSignerBuilder("SHA256withECDSA").build(crlKey.private)),
+                )
+                val trusted = listOf(crlIssuer)
+
+                fun crl(
+                    number: Long,
+                    entries: Map<BigInteger, Int>,
+                    deltaOf: Long? = null,
+                    key: PrivateKey = crlKey.private,
+                ): ByteArray {
+                    val builder = X509v2CRLBuilder(issuerName, Date())
+                    builder.setNextUpdate(Date(System.currentTimeMillis() + 86_400_000L))
+                    builder.addExtension(Extension.cRLNumber, false, CRLNumber(BigInteger.valueOf(number)))
+                    deltaOf?.let {
+                        builder.addExtension(Extension.deltaCRLIndicator, true, CRLNumber(BigInteger.valueOf(it)))
+                    }
+                    entries.forEach { (serial, reason) -> builder.addCRLEntry(serial, Date(), reason) }
+                    return builder.build(JcaContentSignerBuilder("SHA256withECDSA").build(key)).encoded
+                }
+
+                val signed = Signer.fromInfo(SignerInfo(SigningAlgorithm.ES256, certPem, keyPem)).use { signer ->
+                    Builder.fromJson(TEST_MANIFEST_JSON).use { builder ->
+                        DataStream(imageData).use { source ->
+                            ByteArrayStream().use { dest ->
+                                builder.sign("image/jpeg", source, dest, signer)
+                                dest.getData()
+                            }
+                        }
+                    }
+                }
+
+                fun readWith(index: RevocationIndex): Pair<RevocationCheck?, String> =
+                    C2PASettings.create().use { settings ->
+                        C2PAContext.fromSettings(settings, index).use { context ->
+                            DataStream(signed).use { stream ->
+                                Reader.fromContext(context).withStream("image/jpeg", stream).use {
+                                    it.revocationCheck to it.json()
+                                }
+                            }
+                        }
+                    }
+
+                val others = (1L..1000L).associate { BigInteger.valueOf(it) to CRLReason.keyCompromise }
+                val base = RevocationIndex.compile(listOf(crl(1, others)), trusted, indexFile)
+                val beforeRevocation = readWith(base).first
+
+                val revoked = base.applyDelta(
+                    listOf(crl(2, mapOf(leaf.serialNumber to CRLReason.keyCompromise), deltaOf = 1)),
+                    trusted,
+                )
+                val (afterRevocation, revokedJson) = readWith(revoked)
+                val reopened = RevocationIndex.open(indexFile).status(leaf)
+
+                // Revocation is reported beside the native validation report, which is unchanged
+                val reportUnchanged = !revokedJson.contains("signingCredential.revoked")
+
+                // A CRL not signed by a trusted issuer is rejected
+                val forgedRejected = try {
+                    revoked.applyDelta(
+                        listOf(crl(6, emptyMap(), key = keyPair().private)),
+                        trusted,
+                        File.createTempFile("revocation", ".idx").apply { deleteOnExit() },
+                    )
+                    false
+                } catch (e: C2PAError) {
+                    true
+                }
+
+                val restored = revoked.applyDelta(
+                    listOf(crl(3, mapOf(leaf.serialNumber to CRLReason.removeFromCRL), deltaOf = 1)),
+                    trusted,
+                )
+                val afterRemoval = readWith(restored).first
+
+                // Several full CRLs from one issuer in one update are combined, not each
+                // replacing the one before
+                val partitioned = restored.applyDelta(
+                    listOf(crl(4, mapOf(leaf.serialNumber to CRLReason.keyCompromise)), crl(5, others)),
+                    trusted,
+                )
+
+                val success = beforeRevocation?.status == RevocationStatus.GOOD &&
+                    afterRevocation?.status == RevocationStatus.REVOKED &&
+                    reopened == RevocationStatus.REVOKED &&
+                    afterRemoval?.status == RevocationStatus.GOOD &&
+                    restored.revokedCount == 1000L && reportUnchanged && forgedRejected &&
+                    partitioned.status(leaf) == RevocationStatus.REVOKED && partitioned.revokedCount == 1001L &&
+                    base.status(leaf.issuerX500Principal, BigInteger.valueOf(500)) == RevocationStatus.REVOKED &&
+                    base.status(leaf.subjectX500Principal, leaf.serialNumber) == RevocationStatus.UNKNOWN
+                TestResult(
+                    "Revocation Index",
+                    success,
+                    if (success) {
+                        "Signing certificate revocation tracked offline through delta updates"
+                    } else {
+                        "Revocation results were unexpected"
+                    },
+                    "Before: $beforeRevocation, revoked: $afterRevocation, reopened: $reopened, " +
+                        "after removal: $afterRemoval, entries: ${restored.revokedCount}, " +
+                        "report unchanged: $reportUnchanged, forged CRL rejected: $forgedRejected, " +
+                        "partitioned entries: ${partitioned.revokedCount}",
+                )
+            } catch (e: C2PAError) {
+                TestResult("Revocation Index", false, "Failed to build index or read image", e.toString())
+            } finally {
+                indexFile.delete()
+            }
+        }
+    }
 }
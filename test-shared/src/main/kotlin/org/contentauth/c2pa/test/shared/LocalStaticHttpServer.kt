@@ -0,0 +1,128 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.test.shared
+
+import java.io.Closeable
+import java.net.InetAddress
+import java.net.ServerSocket
+import java.net.Socket
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Serves one byte array on the loopback interface, honouring single `Range` requests, for tests.
+ *
+ * With [supportsRanges] false the whole body is always returned with 200, as some servers do.
+ * [maxRangeBytes] caps each partial response, as servers and proxies are allowed to.
+ */
+class LocalStaticHttpServer(
+    private val content: ByteArray,
+    private val supportsRanges: Boolean = true,
+    private val maxRangeBytes: Int = Int.MAX_VALUE,
+) : Closeable {
+
+    private val server = ServerSocket(0, 50, InetAddress.getLoopbackAddress())
+    private val executor = Executors.newCachedThreadPool()
+    private val requests = AtomicInteger()
+    private val bytesServed = AtomicLong()
+
+    /** The URL of the content. */
+    val url: String = "http://127.0.0.1:${server.localPort}/asset"
+
+    /** Number of requests answered. */
+    val requestCount: Int get() = requests.get()
+
+    /** Number of body bytes sent. */
+    val bytesSent: Long get() = bytesServed.get()
+
+    init {
+        executor.execute { acceptLoop() }
+    }
+
+    private fun acceptLoop() {
+        while (!server.isClosed) {
+            val socket = try {
+                server.accept()
+            } catch (e: Exception) {
+                return
+            }
+            executor.execute { handle(socket) }
+        }
+    }
+
+    private fun handle(socket: Socket) {
+        try {
+            socket.use {
+                val headers = readHeaders(it)
+                val range = headers
+                    .firstOrNull { line -> line.startsWith("Range:", ignoreCase = true) }
+                    ?.substringAfter(':')?.trim()
+                    ?.takeIf { supportsRanges }
+                val response = if (range == null) {
+                    Triple("200 OK", "", content)
+                } else {
+                    val match = Regex("bytes=(\\d+)-(\\d*)").matchEntire(range)
+                    val start = match?.groupValues?.get(1)?.toLong() ?: 0
+                    val end = (
+                        match?.groupValues?.get(2)?.toLongOrNull()?.coerceAtMost(content.size - 1L)
+                            ?: (content.size - 1L)
+                        ).coerceAtMost(start + maxRangeBytes - 1)
+                    if (match == null || start >= content.size) {
+                        Triple("416 Range Not Satisfiable", "Content-Range: bytes */${content.size}\r\n", ByteArray(0))
+                    } else {
+                        Triple(
+                            "206 Partial Content",
+                            "Content-Range: bytes $start-$end/${content.size}\r\n",
+                            content.copyOfRange(start.toInt(), end.toInt() + 1),
+                        )
+                    }
+                }
+                val (status, extraHeaders, body) = response
+                val output = it.getOutputStream()
+                output.write(
+                    (
+                        "HTTP/1.1 $status\r\n" +
+                            "Content-Type: application/octet-stream\r\n" +
+                            (if (supportsRanges) "Accept-Ranges: bytes\r\n" else "") +
+                            extraHeaders +
+                            "Content-Length: ${body.size}\r\n" +
+                            "Connection: close\r\n\r\n"
+                        ).toByteArray(),
+                )
+                output.write(body)
+                output.flush()
+                requests.incrementAndGet()
+                bytesServed.addAndGet(body.size.toLong())
+            }
+        } catch (e: Exception) {
+            // The client sees a closed connection
+        }
+    }
+
+    private fun readHeaders(socket: Socket): List<String> {
+        val reader = socket.getInputStream().bufferedReader(Charsets.US_ASCII)
+        val lines = mutableListOf<String>()
+        while (true) {
+            val line = reader.readLine() ?: break
+            if (line.isEmpty()) break
+            lines += line
+        }
+        return lines
+    }
+
+    override fun close() {
+        server.close()
+        executor.shutdownNow()
+    }
+}
@@ -0,0 +1,176 @@
+/*
+This file is licensed to you under the Apache License, Version 2.0
+(http://www.apache.org/licenses/LICENSE-2.0) or the MIT license
+(http://opensource.org/licenses/MIT), at your option.
+
+Unless required by applicable law or agreed to in writing, this software is
+distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS OF
+ANY KIND, either express or implied. See the LICENSE-MIT and LICENSE-APACHE
+files for the specific language governing permissions and limitations under
+each license.
+*/
+
+package org.contentauth.c2pa.test.shared
+
+import org.bouncycastle.asn1.ASN1ObjectIdentifier
+import org.bouncycastle.asn1.oiw.OIWObjectIdentifiers
+import org.bouncycastle.asn1.x500.X500Name
+import org.bouncycastle.asn1.x509.AlgorithmIdentifier
+import org.bouncycastle.asn1.x509.ExtendedKeyUsage
+import org.bouncycastle.asn1.x509.Extension
+import org.bouncycastle.asn1.x509.KeyPurposeId
+import org.bouncycastle.cert.jcajce.JcaCertStore
+import org.bouncycastle.cert.jcajce.JcaX509CertificateConverter
+import org.bouncycastle.cert.jcajce.JcaX509v3CertificateBuilder
+import org.bouncycastle.cms.jcajce.JcaSimpleSignerInfoGeneratorBuilder
+import org.bouncycastle.jce.provider.BouncyCastleProvider
+import org.bouncycastle.operator.jcajce.JcaContentSignerBuilder
+import org.bouncycastle.operator.jcajce.JcaDigestCalculatorProviderBuilder
+import org.bouncycastle.tsp.TSPAlgorithms
+import org.bouncycastle.tsp.TimeStampRequest
+import org.bouncycastle.tsp.TimeStampResponseGenerator
+import org.bouncycastle.tsp.TimeStampTokenGenerator
+import java.io.ByteArrayOutputStream
+import java.io.Closeable
+import java.io.InputStream
+import java.math.BigInteger
+import java.net.InetAddress
+import java.net.ServerSocket
+import java.net.Socket
+import java.security.KeyPairGenerator
+import java.security.spec.ECGenParameterSpec
+import java.util.Date
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * A minimal RFC 3161 time stamp authority on the loopback interface, for tests.
+ *
+ * Each response is delayed by [latencyMillis] to stand in for a remote TSA. The authority counts
+ * requests and records the largest number it was handling at once.
+ */
+class LocalTimestampAuthority(private val latencyMillis: Long) : Closeable {
+
+    private val provider = BouncyCastleProvider()
+    private val server = ServerSocket(0, 50, InetAddress.getLoopbackAddress())
+    private val executor = Executors.newCachedThreadPool()
+    private val responseGenerator: TimeStampResponseGenerator
+    private val serial = AtomicLong()
+    private val active = AtomicInteger()
+    private val peak = AtomicInteger()
+    private val handled = AtomicInteger()
+
+    /** The URL to use as a signer's TSA URL. */
+    val url: String = "http://127.0.0.1:${server.localPort}/"
+
+    /** Number of requests answered. */
+    val requestCount: Int get() = handled.get()
+
+    /** Largest number of requests in progress at the same time. */
+    val peakConcurrentRequests: Int get() = peak.get()
+
+    init {
+        val keyPair = KeyPairGenerator.getInstance("EC")
+            .apply { initialize(ECGenParameterSpec("secp256r1")) }
+            .generateKeyPair()
+        val now = System.currentTimeMillis()
+        val subject = X500Name("CN=Local Test TSA, O=C2PA Test Suite")
+        val certificate = JcaX509CertificateConverter().setProvider(provider).getCertificate(
+            JcaX509v3CertificateBuilder(
+                subject,
+                BigInteger.valueOf(now),
+                Date(now - 3_600_000),
+                Date(now + 86_400_000),
+                subject,
+                keyPair.public,
+            )
+                .addExtension(Extension.extendedKeyUsage, true, ExtendedKeyUsage(KeyPurposeId.id_kp_timeStamping))
+                .build(JcaContentSignerBuilder("SHA256withECDSA").setProvider(provider).build(keyPair.private)),
+        )
+
+        val digestProvider = JcaDigestCalculatorProviderBuilder().setProvider(provider).build()
+        val signerInfoGenerator = JcaSimpleSignerInfoGeneratorBuilder()
+            .setProvider(provider)
+            .build("SHA256withECDSA", keyPair.private, certificate)
+        val tokenGenerator = TimeStampTokenGenerator(
+            signerInfoGenerator,
+            digestProvider.get(AlgorithmIdentifier(OIWObjectIdentifiers.idSHA1)),
+            ASN1ObjectIdentifier("1.2.3.4.1"),
+        )
+        tokenGenerator.addCertificates(JcaCertStore(listOf(certificate)))
+        responseGenerator = TimeStampResponseGenerator(tokenGenerator, TSPAlgorithms.ALLOWED)
+
+        executor.execute { acceptLoop() }
+    }
+
+    private fun acceptLoop() {
+        while (!server.isClosed) {
+            val socket = try {
+                server.accept()
+            } catch (e: Exception) {
+                return
+            }
+            executor.execute { handle(socket) }
+        }
+    }
+
+    private fun handle(socket: Socket) {
+        peak.accumulateAndGet(active.incrementAndGet(), ::maxOf)
+        try {
+            socket.use {
+                val input = it.getInputStream()
+                val body = readRequestBody(input)
+                Thread.sleep(latencyMillis)
+                val response = synchronized(responseGenerator) {
+                    responseGenerator.generate(TimeStampRequest(body), BigInteger.valueOf(serial.incrementAndGet()), Date())
+                }.encoded
+                val output = it.getOutputStream()
+                output.write(
+                    (
+                        "HTTP/1.1 200 OK\r\n" +
+                            "Content-Type: application/timestamp-reply\r\n" +
+                            "Content-Length: ${response.size}\r\n" +
+                            "Connection: close\r\n\r\n"
+                        ).toByteArray(),
+                )
+                output.write(response)
+                output.flush()
+                handled.incrementAndGet()
+            }
+        } catch (e: Exception) {
+            // The client sees a closed connection
+        } finally {
+            active.decrementAndGet()
+        }
+    }
+
+    private fun readRequestBody(input: InputStream): ByteArray {
+        val header = ByteArrayOutputStream()
+        var matched = 0
+        val terminator = "\r\n\r\n"
+        while (matched < terminator.length) {
+            val byte = input.read()
+            require(byte >= 0) { "Connection closed before request headers ended" }
+            header.write(byte)
+            matched = if (byte.toChar() == terminator[matched]) matched + 1 else if (byte == '\r'.code) 1 else 0
+        }
+        val contentLength = header.toString(Charsets.US_ASCII.name()).lineSequence()
+            .firstOrNull { it.startsWith("Content-Length:", ignoreCase = true) }
+            ?.substringAfter(':')?.trim()?.toInt()
+            ?: throw IllegalArgumentException("Missing Content-Length")
+        val body = ByteArray(contentLength)
+        var read = 0
+        while (read < contentLength) {
+            val count = input.read(body, read, contentLength - read)
+            require(count >= 0) { "Connection closed before request body ended" }
+            read += count
+        }
+        return body
+    }
+
+    override fun close() {
+        server.close()
+        executor.shutdownNow()
+    }
+}
@@ -53,7 +53,13 @@ import org.contentauth.c2pa.manifest.Relationship
 import org.contentauth.c2pa.manifest.TrainingMiningEntry
 import org.contentauth.c2pa.manifest.CawgTrainingMiningEntry
 import org.contentauth.c2pa.manifest.ManifestValidator
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.json.Json
 import kotlinx.serialization.json.JsonElement
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.jsonPrimitive
+import org.contentauth.c2pa.C2PACbor
+import org.contentauth.c2pa.manifest.ManifestStoreView
 import org.contentauth.c2pa.Builder
 import org.contentauth.c2pa.ByteArrayStream
 import org.contentauth.c2pa.C2PA
@@ -2757,4 +2763,195 @@ abstract class ManifestTests : TestBase() {
             }
         }
     }
+
+    suspend fun testManifestStoreView(): TestResult = withContext(Dispatchers.IO) {
+        runTest("ManifestStoreView lazy access") {
+            try {
+                val storeJson = """
+                    {
+                      "active_manifest": "urn:c2pa:active",
+                      "manifests": {
+                        "urn:c2pa:parent": {
+                          "title": "parent.jpg",
+                          "assertions": []
+                        },
+                        "urn:c2pa:active": {
+                          "title": "photo \"edited\".jpg",
+                          "format": "image/jpeg",
+                          "claim_generator_info": [{ "name": "test-app", "version": "1.0" }],
+                          "assertions": [
+                            { "label": "com.example.first", "data": { "n": 1, "nested": [1.5, true, null] } },
+                            { "label": "com.example.second", "data": { "text": "caf\u00e9" } }
+                          ],
+                          "ingredients": [
+                            { "title": "parent.jpg", "format": "image/jpeg", "relationship": "parentOf" }
+                          ],
+                          "signature_info": { "alg": "Es256", "issuer": "C2PA Test Signing Cert", "time": "2024-01-01T00:00:00Z" }
+                        }
+                      },
+                      "validation_status": [
+                        { "code": "claimSignature.validated" },
+                        { "code": "signingCredential.trusted", "explanation": "trusted" }
+                      ],
+                      "validation_state": "Trusted"
+                    }
+                """.trimIndent()
+
+                val views = listOf(
+                    "JSON" to ManifestStoreView.fromJson(storeJson),
+                    "CBOR" to ManifestStoreView.fromCbor(C2PACbor.encodeToByteArray(Json.parseToJsonElement(storeJson))),
+                )
+
+                val failures = mutableListOf<String>()
+                for ((name, view) in views) {
+                    val active = view.activeManifest()
+                    if (view.manifestLabels != listOf("urn:c2pa:parent", "urn:c2pa:active")) failures.add("$name labels")
+                    if (view.validationState != "Trusted") failures.add("$name state")
+                    if (view.validationStatusCount != 2) failures.add("$name status count")
+                    if (view.validationStatus(1).code != ValidationStatusCode.SIGNING_CREDENTIAL_TRUSTED) {
+                        failures.add("$name status code")
+                    }
+                    if (active == null) {
+                        failures.add("$name active manifest")
+                        continue
+                    }
+                    if (active.title != "photo \"edited\".jpg") failures.add("$name title")
+                    if (active.signatureIssuer != "C2PA Test Signing Cert") failures.add("$name issuer")
+                    if (active.claimGeneratorInfo.firstOrNull()?.name != "test-app") failures.add("$name generator")
+                    if (active.assertionLabels != listOf("com.example.first", "com.example.second")) {
+                        failures.add("$name assertion labels")
+                    }
+                    val second = active.assertion("com.example.second") as? AssertionDefinition.Custom
+                    if ((second?.data as? JsonObject)?.get("text")?.jsonPrimitive?.content != "caf\u00e9") {
+                        failures.add("$name assertion data")
+                    }
+                    if (active.ingredientCount != 1 || active.ingredient(0).relationship != Relationship.PARENT_OF) {
+                        failures.add("$name ingredient")
+                    }
+                    if (view.manifest("urn:c2pa:missing") != null) failures.add("$name missing manifest")
+                    if (active.assertion(0) !== active.assertion(0) || active.ingredient(0) !== active.ingredient(0)) {
+                        failures.add("$name decoded values not cached")
+                    }
+                }
+
+                val malformed = listOf(
+                    """{"title": invalid}""",
+                    """{"a": 1}xyz""",
+                    """{"a": 1 "b": 2}""",
+                    """{"a": [1 2]}""",
+                    """{"a": tru}""",
+                    """{"a": 01}""",
+                )
+                malformed.filter { json ->
+                    try {
+                        ManifestStoreView.fromJson(json).validationState
+                        true
+                    } catch (e: SerializationException) {
+                        false
+                    }
+                }.forEach { failures.add("accepted malformed JSON $it") }
+
+                // Nesting far past the depth limit must fail cleanly rather than overflow the stack
+                val deepCbor = ByteArray(100_000) { 0x81.toByte() } + 0x00
+                try {
+                    ManifestStoreView.fromCbor(deepCbor).validationState
+                    failures.add("accepted deeply nested CBOR")
+                } catch (e: SerializationException) {
+                    // expected
+                }
+
+                // {"a": [...]} with an array length of 2^64 - 1, which must not wrap to a small count
+                val hugeCount = byteArrayOf(0xA1.toByte(), 0x61, 'a'.code.toByte(), 0x9B.toByte()) +
+                    ByteArray(8) { 0xFF.toByte() }
+                try {
+                    ManifestStoreView.fromCbor(hugeCount).validationState
+                    failures.add("accepted CBOR length above Long.MAX_VALUE")
+                } catch (e: SerializationException) {
+                    // expected
+                }
+
+                val success = failures.isEmpty()
+
+                TestResult(
+                    "ManifestStoreView lazy access",
+                    success,
+                    if (success) {
+                        "Lazy view decodes JSON and CBOR stores on demand"
+                    } else {
+                        "Lazy view returned unexpected values"
+                    },
+                    "Failures: $failures",
+                )
+            } catch (e: Exception) {
+                TestResult(
+                    "ManifestStoreView lazy access",
+                    false,
+                    "Exception: ${e.message}",
+                    e.toString(),
+                )
+            }
+        }
+    }
+
+    suspend fun testManifestValidatorBatch(): TestResult = withContext(Dispatchers.IO) {
+        runTest("ManifestValidator batch validation") {
+            try {
+                val manifests = listOf(
+                    ManifestDefinition(
+                        title = "Valid",
+                        claimGeneratorInfo = listOf(ClaimGeneratorInfo(name = "test")),
+                    ),
+                    ManifestDefinition(
+                        title = "Typo",
+                        claimGeneratorInfo = listOf(ClaimGeneratorInfo(name = "test")),
+                        assertions = listOf(
+                            AssertionDefinition.custom("c2pa.action", buildJsonObject { put("key", "value") }),
+                        ),
+                    ),
+                    ManifestDefinition(title = "No generator", claimGeneratorInfo = emptyList()),
+                )
+
+                val batch = ManifestValidator.validateAll(manifests)
+                val single = manifests.map { ManifestValidator.validate(it) }
+                val batchMatches = batch == single
+
+                val jsons = listOf(
+                    """{"claim_version": 1, "assertions": [{"label": "stds.exif", "data": {"a": [1, {"b": "}"}]}}]}""",
+                    """{"title": "ok", "claim_version": 2, "assertions": [{"data": {}, "label": "com.example.x"}]}""",
+                    """{ "title": invalid""",
+                    """{"title": invalid}""",
+                    """{"a": 1}xyz""",
+                    """{"a": 1 "b": 2}""",
+                )
+                val jsonResults = ManifestValidator.validateJsonAll(jsons)
+                val deprecatedFound = jsonResults[0].warnings.any { it.contains("'stds.exif' in assertions is deprecated") }
+                val versionFound = jsonResults[0].warnings.any { it.contains("claim_version is 1") }
+                val cleanJson = jsonResults[1].isValid() && !jsonResults[1].hasWarnings()
+                // Truncated, invalid literal, trailing data and missing comma
+                val malformedRejected = jsonResults.drop(2).all { it.hasErrors() } &&
+                    jsons.drop(2).all { ManifestValidator.validateJson(it, logWarnings = false).hasErrors() }
+
+                val success = batchMatches && deprecatedFound && versionFound && cleanJson && malformedRejected
+
+                TestResult(
+                    "ManifestValidator batch validation",
+                    success,
+                    if (success) {
+                        "Batch validation matches single validation"
+                    } else {
+                        "Batch validation mismatch"
+                    },
+                    "Batch matches: $batchMatches, Deprecated: $deprecatedFound, Version: $versionFound, " +
+                        "Clean: $cleanJson, Malformed rejected: $malformedRejected",
+                )
+            } catch (e: Exception) {
+                TestResult(
+                    "ManifestValidator batch validation",
+                    false,
+                    "Exception: ${e.message}",
+                    e.toString(),
+                )
+            }
+        }
+    }
 }
@@ -19,7 +19,9 @@ import org.contentauth.c2pa.ByteArrayStream
 import org.contentauth.c2pa.C2PA
 import org.contentauth.c2pa.C2PAError
 import org.contentauth.c2pa.CallbackStream
+import org.contentauth.c2pa.DataStream
 import org.contentauth.c2pa.FileStream
+import org.contentauth.c2pa.HttpRangeStream
 import org.contentauth.c2pa.Reader
 import org.contentauth.c2pa.SeekMode
 import java.io.ByteArrayOutputStream
@@ -411,4 +413,87 @@ abstract class StreamTests : TestBase() {
             }
         }
     }
+
+    suspend fun testHttpRangeStream(): TestResult = withContext(Dispatchers.IO) {
+        runTest("HTTP Range Stream") {
+            val testImageData = loadResourceAsBytes("adobe_20220124_ci")
+            val blockSize = 4 * 1024
+
+            try {
+                val expectedJson = DataStream(testImageData).use { stream ->
+                    Reader.fromStream("image/jpeg", stream).use { it.json() }
+                }
+
+                LocalStaticHttpServer(testImageData).use { server ->
+                    // A small read near the end fetches only the blocks it touches, after the first
+                    // block that reports the asset size
+                    val tailRead = HttpRangeStream(server.url, blockSize = blockSize).use { stream ->
+                        stream.seek(-100, SeekMode.END.value)
+                        val buffer = ByteArray(100)
+                        val read = stream.read(buffer, 100)
+                        val matches = read == 100L &&
+                            buffer.contentEquals(testImageData.copyOfRange(testImageData.size - 100, testImageData.size))
+                        matches && stream.stats().bytesFetched <= 3L * blockSize
+                    }
+
+                    // A sequential scan is served by read-ahead in far fewer requests than blocks
+                    val before = server.requestCount
+                    val (scanMatches, scanRequests) = HttpRangeStream(server.url, blockSize = blockSize).use { stream ->
+                        val copy = ByteArrayOutputStream()
+                        val buffer = ByteArray(1024)
+                        while (true) {
+                            val read = stream.read(buffer, buffer.size.toLong())
+                            if (read <= 0L) break
+                            copy.write(buffer, 0, read.toInt())
+                        }
+                        copy.toByteArray().contentEquals(testImageData) to server.requestCount - before
+                    }
+                    val blocks = (testImageData.size + blockSize - 1) / blockSize
+
+                    // Full verification over the network matches verification from memory
+                    val remoteJson = HttpRangeStream(server.url, blockSize = blockSize).use { stream ->
+                        Reader.fromStream("image/jpeg", stream).use { it.json() }
+                    }
+
+                    // A server without range support still works
+                    val fallbackJson = LocalStaticHttpServer(testImageData, supportsRanges = false).use { plain ->
+                        HttpRangeStream(plain.url, blockSize = blockSize).use { stream ->
+                            Reader.fromStream("image/jpeg", stream).use { it.json() }
+                        }
+                    }
+
+                    // A server that answers with fewer bytes than asked is followed up until each
+                    // range is complete
+                    val shortJson = LocalStaticHttpServer(testImageData, maxRangeBytes = 1500).use { short ->
+                        HttpRangeStream(short.url, blockSize = blockSize).use { stream ->
+                            Reader.fromStream("image/jpeg", stream).use { it.json() }
+                        }
+                    }
+
+                    val success = tailRead && scanMatches && scanRequests < blocks / 2 &&
+                        remoteJson == expectedJson && fallbackJson == expectedJson && shortJson == expectedJson
+                    TestResult(
+                        "HTTP Range Stream",
+                        success,
+                        if (success) {
+                            "Range stream reads match the asset and verify identically"
+                        } else {
+                            "Range stream reads or verification differed"
+                        },
+                        "Tail read ok: $tailRead, scan: $scanRequests requests for $blocks blocks, " +
+                            "remote json matches: ${remoteJson == expectedJson}, " +
+                            "fallback json matches: ${fallbackJson == expectedJson}, " +
+                            "short response json matches: ${shortJson == expectedJson}",
+                    )
+                }
+            } catch (e: Exception) {
+                TestResult(
+                    "HTTP Range Stream",
+                    false,
+                    "Exception during range stream test: ${e.message}",
+                    e.toString(),
+                )
+            }
+        }
+    }
 }
@@ -195,6 +195,84 @@ abstract class WebServiceTests : TestBase() {
         }
     }
 
+    suspend fun testHedgedWebServiceSigning(): TestResult = withContext(Dispatchers.IO) {
+        runTest("Hedged Web Service Signing") {
+            val certPem = loadResourceAsString("es256_certs")
+            val keyPem = loadResourceAsString("es256_private")
+            val testImageData = loadResourceAsBytes("adobe_20220124_ci")
+
+            suspend fun signWith(webServiceSigner: WebServiceSigner): Pair<Boolean, Long> {
+                val signer = webServiceSigner.createSigner()
+                return signer.use {
+                    val start = System.nanoTime()
+                    Builder.fromJson(TEST_MANIFEST_JSON).use { builder ->
+                        DataStream(testImageData).use { sourceStream ->
+                            ByteArrayStream().use { destStream ->
+                                builder.sign("image/jpeg", sourceStream, destStream, signer)
+                                val elapsed = TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start)
+                                val manifest = Reader.fromStream("image/jpeg", ByteArrayStream(destStream.getData()))
+                                    .use { reader -> reader.json() }
+                                manifest.isNotEmpty() to elapsed
+                            }
+                        }
+                    }
+                }
+            }
+
+            try {
+                // A slow primary and a fast fallback: the hedge should win well before the primary answers
+                val hedgeResult = LocalSigningServer(certPem, keyPem, latencyMillis = 3_000).use { slow ->
+                    LocalSigningServer(certPem, keyPem, latencyMillis = 20).use { fast ->
+                        val webServiceSigner = WebServiceSigner(
+                            configurationURL = slow.configurationURL,
+                            policy = WebServiceSigner.RequestPolicy(initialHedgeDelayMillis = 200),
+                            fallbackSigningURLs = listOf(fast.signingURL),
+                        )
+                        val (signed, elapsed) = signWith(webServiceSigner)
+                        val fastStats = webServiceSigner.endpointStats().firstOrNull { it.url == fast.signingURL }
+                        Triple(
+                            signed && elapsed < 3_000 && fast.signedCount >= 1 && (fastStats?.hedgesWon ?: 0) >= 1,
+                            "hedged: ${elapsed}ms, slow requests ${slow.requestCount}, fast signed ${fast.signedCount}",
+                            webServiceSigner.endpointStats().joinToString("\n"),
+                        )
+                    }
+                }
+
+                // A single flaky instance: two injected 503s are retried with backoff
+                val retryResult = LocalSigningServer(certPem, keyPem, failuresBeforeSuccess = 2).use { flaky ->
+                    val webServiceSigner = WebServiceSigner(
+                        configurationURL = flaky.configurationURL,
+                        policy = WebServiceSigner.RequestPolicy(hedging = false, maxAttempts = 3, backoffBaseMillis = 20),
+                    )
+                    val (signed, elapsed) = signWith(webServiceSigner)
+                    Pair(
+                        signed && flaky.requestCount == 3 && flaky.signedCount == 1,
+                        "retried: ${elapsed}ms, ${flaky.requestCount} requests",
+                    )
+                }
+
+                val success = hedgeResult.first && retryResult.first
+                TestResult(
+                    "Hedged Web Service Signing",
+                    success,
+                    if (success) {
+                        "Hedged and retried requests signed within budget"
+                    } else {
+                        "Hedging or retries did not behave as expected"
+                    },
+                    "${hedgeResult.second}\n${retryResult.second}\n${hedgeResult.third}",
+                )
+            } catch (e: Exception) {
+                TestResult(
+                    "Hedged Web Service Signing",
+                    false,
+                    "Exception during hedged signing: ${e.message}",
+                    "${e.javaClass.simpleName}: ${e.message}\n${e.stackTraceToString().take(500)}",
+                )
+            }
+        }
+    }
+
     suspend fun testCSRSigning(): TestResult = withContext(Dispatchers.IO) {
         if (!isServerAvailable()) {
             return@withContext TestResult(